@@ -2,33 +2,164 @@
 #pragma once
 #include <vector>
 #include <string>
-#include <unordered_map>
 #include <random>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
 
 #include "types.h"
 #include "gameLogic.h"
+#include "transpositionTable.h"
+#include "pawnHashTable.h"
+#include "evalCache.h"
+#include "openingBook.h"
+#include "tablebase.h"
 class AI
 {
 public:
-    explicit AI(Chessboard &board) : chessboard(board), rng(std::random_device{}()) {}
+    explicit AI(Chessboard &board,
+                const Types::SearchOptions &searchOptions = Types::SearchOptions())
+        : chessboard(board), rng(std::random_device{}()),
+          transpositionTable(static_cast<size_t>(searchOptions.hashSizeMb)),
+          evalCache(static_cast<size_t>(searchOptions.evalCacheSizeMb))
+    {
+        setOptions(searchOptions);
+    }
+    void setOptions(const Types::SearchOptions &searchOptions);
+    const Types::SearchOptions &getOptions() const { return options; }
     Types::Turn minMax(char player, int turn, bool alt, int depth,
                        float alpha, float beta);
-    float minMaxHelper(GameLogic gameLogic, char player, int turn, bool alt,
-                       int depth, float alpha, float beta);
     std::vector<Types::Turn> generateAllLegalMoves(char player, int turn,
                                                    bool alt);
     float evaluateBoard();
+    // the loaded network's score of the board, callers check Nnue::isLoaded
+    float evaluateNnue();
     float evaluatePosition(const std::string &piece, int col, int row);
+    float evaluatePawns();
     float evaluatePawnStructure(int col, int row, bool isWhite);
     float evaluatePieceMobility(const std::string &piece, int col, int row);
     float evaluateKingSafety(int col, int row, bool isWhite);
-    float evaluateCenterControl(int col, int row);
-    float quiescenceSearch(char player, float alpha, float beta,
-                           int maxDepth = 3);
-    std::vector<Types::Turn> generateCaptureMoves(char player);
+    std::vector<Types::Turn> generateCaptureMoves(char player, bool alt);
+    float staticExchangeEvaluation(const Types::Turn &move, bool alt);
+    void orderMoves(std::vector<Types::Turn> &moves, bool alt);
+
+    bool hasNonPawnMaterial(char player);
+
+    // cuts the running search short from any thread, minMax then returns
+    // the best move of the last finished iteration. The request stays until
+    // clearStop, so it is not lost when it comes before the search starts
+    void stop() { stopRequested.store(true, std::memory_order_relaxed); }
+    void clearStop() { stopRequested.store(false, std::memory_order_relaxed); }
+    // called on the searching thread after every finished iteration with
+    // its best line
+    using IterationCallback = std::function<void(const Types::IterationStats &,
+                                                 const std::vector<Types::Turn> &)>;
+    void setIterationCallback(IterationCallback callback)
+    {
+        iterationCallback = std::move(callback);
+    }
+
+    // best line found by the last minMax call, starting with the move played
+    const std::vector<Types::Turn> &getPrincipalVariation() const
+    {
+        return principalVariation;
+    }
+    // statistics of the last minMax call
+    const Types::SearchStats &getSearchStats() const { return stats; }
+    long long getSearchNodes() const { return stats.nodes; }
+    long long getQuiescenceNodes() const { return stats.quiescenceNodes; }
+    void clearTranspositionTable() { transpositionTable.clear(); }
+    // cached evaluations go stale when the evaluation weights change
+    void clearEvaluationCaches()
+    {
+        pawnHash.clear();
+        evalCache.clear();
+    }
+    bool loadOpeningBook(const std::string &path) { return openingBook.open(path); }
+    int loadTablebases(const std::string &directory) { return tablebase.load(directory); }
+    bool pickBookMove(char player, bool alt,
+                      const std::vector<Types::Turn> &legalMoves,
+                      Types::Turn &move);
+    static std::string iterationJson(const Types::IterationStats &iteration);
+    static std::string searchJson(const Types::SearchStats &searchStats);
+
+    // score given to the side that delivers checkmate
+    static constexpr float MATE_SCORE = 10000.0f;
+    // tablebase wins score below real mates, less a point per ply to mate
+    static constexpr float TABLEBASE_WIN = 5000.0f;
+    // margin added on top of the captured piece when delta pruning
+    static constexpr float DELTA_MARGIN = 2.0f;
+    // quiescence nodes one leaf's quiescence search may spend before its
+    // remaining nodes fall back to the static evaluation
+    static constexpr long long MAX_QUIESCENCE_NODES = 20000;
+    // captures deep the quiescence search goes before standing pat
+    static constexpr int QUIESCENCE_DEPTH = 6;
+    // width of the zero window used by null move and reduced searches
+    static constexpr float NULL_WINDOW = 0.001f;
+    static constexpr int REDUCTION_TABLE_SIZE = 64;
+    // half width of the first aspiration window around the last score,
+    // doubled on every fail and dropped entirely past the maximum
+    static constexpr float ASPIRATION_WINDOW = 0.5f;
+    static constexpr float MAX_ASPIRATION_WINDOW = 8.0f;
+    // root moves within this of the best score count as tied
+    static constexpr float TIE_MARGIN = 0.005f;
+    static constexpr int MAX_PLY = 64;
+    // nodes between looks at the stop request and the clock, a power of two
+    static constexpr long long STOP_CHECK_INTERVAL = 1024;
 
 private:
-    static const std::unordered_map<char, float> pieceValues;
+    // the search is specialised on the rule set and the side to move, minMax
+    // dispatches once and these are only instantiated from ai.cpp
+    template <bool Alt, char Player>
+    Types::Turn iterativeDeepening(int turn, int depth, float alpha, float beta);
+    template <bool Alt, char Player>
+    float searchRoot(const std::vector<Types::Turn> &rootMoves, int turn,
+                     int depth, float alpha, float beta,
+                     std::vector<Types::Turn> &bestMoves,
+                     std::vector<std::vector<Types::Turn>> &bestLines);
+    template <bool Alt, char Player>
+    float minMaxHelper(GameLogic gameLogic, int turn, int depth, float alpha,
+                       float beta, bool nullMoveAllowed = true);
+    template <bool Alt, char Player>
+    float quiescenceSearch(float alpha, float beta, long long nodeBudgetEnd,
+                           int maxDepth = QUIESCENCE_DEPTH, int ply = 0);
+    template <bool Alt, char Player>
+    std::vector<Types::Turn> generateAllLegalMoves(int turn);
+    template <bool Alt, char Player>
+    std::vector<Types::Turn> generateCaptureMoves();
+    template <bool Alt>
+    float staticExchangeEvaluation(const Types::Turn &move);
+    template <bool Alt>
+    void orderMoves(std::vector<Types::Turn> &moves);
+
+    bool searchStopped();
+    static float exchangeValue(const Types::Piece &piece);
+    static bool sameMove(const Types::Turn &a, const Types::Turn &b);
+    Types::SearchStats stats;
     Chessboard &chessboard;
     std::mt19937 rng;
+    Types::SearchOptions options;
+    TranspositionTable transpositionTable;
+    PawnHashTable pawnHash;
+    EvalCache evalCache;
+    OpeningBook openingBook;
+    Tablebase tablebase;
+    // late move reductions indexed by [depth][moveNumber]
+    std::array<std::array<int, REDUCTION_TABLE_SIZE>, REDUCTION_TABLE_SIZE>
+        reductionTable{};
+
+    // triangular principal variation table, row `ply` holds the best line
+    // from that ply on in entries [ply, pvLength[ply])
+    std::array<std::array<Types::Turn, MAX_PLY>, MAX_PLY> pvTable{};
+    std::array<int, MAX_PLY> pvLength{};
+    std::vector<Types::Turn> previousPv;
+    std::vector<Types::Turn> principalVariation;
+    int rootTurn = 0;
+
+    std::atomic<bool> stopRequested{false};
+    // set once the running search gives up, every node then unwinds
+    bool aborted = false;
+    std::chrono::high_resolution_clock::time_point searchStart;
+    IterationCallback iterationCallback;
 };
@@ -39,6 +39,11 @@ private:
     // Analysis mode state
     int currentMoveIndex = 0; // 0 = initial position, 1 = after first move, etc.
     Types::Board initialBoard; // Store the initial board state
+
+    // Engine best line for the position at bestLineMoveIndex
+    std::vector<Types::Turn> bestLine;
+    float bestLineScore = 0.0f;
+    int bestLineMoveIndex = -1;
     
     void loadGames();
     void handleScrolling(sf::Event &event, float listHeight);
@@ -54,5 +59,7 @@ private:
     void drawNavigationControls(sf::RenderWindow &window);
     void drawMoveList(sf::RenderWindow &window, const sf::RectangleShape &panel);
     void drawCapturedPiecesPanel(sf::RenderWindow &window, const sf::RectangleShape &panel);
+    void drawBestLinePanel(sf::RenderWindow &window, const sf::RectangleShape &panel);
+    void calculateBestLine();
     std::string formatMove(const Types::Turn &turn, int moveNumber);
 };
\ No newline at end of file
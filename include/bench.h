@@ -0,0 +1,29 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#pragma once
+#include <vector>
+
+// fixed depth searches over a fixed suite of positions, from all three
+// starting arrays under both rule sets and from an archived game. Searches
+// are deterministic with the hand written evaluation at its default weights
+// and no book, tablebases or network, so the total node count is a
+// signature of the search: it only moves when the search behaves
+// differently, while the time taken measures its speed
+class Bench
+{
+public:
+    static constexpr int DEFAULT_DEPTH = 4;
+
+    struct Result
+    {
+        long long nodes = 0;
+        double seconds = 0.0;
+        double nodesPerSecond = 0.0;
+    };
+
+    // searches the suite on this thread's board and reports each position
+    // and the totals on stderr. The board and the evaluation weights are
+    // put back afterwards
+    static Result run(int depth = DEFAULT_DEPTH);
+    // the suite, in the notation of notation.h
+    static const std::vector<const char *> &positions();
+};
@@ -1,7 +1,10 @@
 // Copyright 2024. mirror-shades. GPL-2.0 License.
 #pragma once
 #include <array>
+#include <cstdint>
 #include "types.h"
+#include "evaluation.h"
+#include "nnue.h"
 
 class Chessboard
 {
@@ -26,7 +29,22 @@ public:
     void setCell(Types::Coord coord, const Types::Piece &value);
     bool isValidCoord(Types::Coord coord) const;
     void printBoard() const;
+    // running Evaluation::staticTerms of the board, kept up to date by
+    // setCell and recomputed whenever the whole board is replaced
+    const Evaluation::Terms &getStaticTerms() const { return staticTerms; }
+    int getStaticScore() const { return Evaluation::taper(staticTerms); }
+    // zobrist keys of all pieces and of the pawns alone, kept up to date
+    // the same way. Zobrist::hash is the piece key xor Zobrist::stateKey
+    uint64_t getPieceKey() const { return pieceKey; }
+    uint64_t getPawnKey() const { return pawnKey; }
+    // first layer of the NNUE network, only kept while one is loaded
+    const Nnue::Accumulator &getAccumulator() const { return accumulator; }
 
 private:
     Types::Board chessboard;
+    Evaluation::Terms staticTerms;
+    uint64_t pieceKey = 0;
+    uint64_t pawnKey = 0;
+    Nnue::Accumulator accumulator;
+    void rescan();
 };
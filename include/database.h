@@ -21,6 +21,8 @@ public:
     
     // Generate next game ID
     static int getNextGameId();
+
+    static std::string getCurrentTimestamp();
     
 private:
     static std::string getGamesDirectory();
@@ -28,5 +30,4 @@ private:
     static std::string getActiveGameFilename();
     static Types::GameRecord parseGameFromCSV(const std::string& filepath);
     static bool writeGameToCSV(const Types::GameRecord& game, const std::string& filepath);
-    static std::string getCurrentTimestamp();
 };
\ No newline at end of file
@@ -0,0 +1,32 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// direct mapped cache of evaluateBoard results keyed by the zobrist key of
+// the pieces. Lock free so search threads can share one: each slot stores
+// the data word and the key xor the data, a torn write from two threads
+// fails the check on probe and simply reads as a miss
+class EvalCache
+{
+public:
+    explicit EvalCache(size_t sizeMb = 4);
+    void resize(size_t sizeMb);
+    void clear();
+    bool probe(uint64_t key, float &score) const;
+    void store(uint64_t key, float score);
+    size_t size() const { return count; }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> check{0};
+        std::atomic<uint64_t> data{0};
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t count = 0;
+    size_t mask = 0;
+};
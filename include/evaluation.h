@@ -0,0 +1,125 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#pragma once
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+#include "types.h"
+
+// static part of the evaluation, material plus piece-square tables, the
+// terms that only depend on a piece and the square it stands on. Chessboard
+// keeps their sums up to date on every setCell so the search pays for them
+// per move instead of per leaf. Scores are white-relative and in hundredths
+// of a pawn so that making and unmaking moves never drifts
+class Evaluation
+{
+public:
+    // middlegame and endgame sums plus the game phase they are tapered by
+    struct Terms
+    {
+        int middlegame = 0;
+        int endgame = 0;
+        int phase = 0;
+
+        Terms &operator+=(const Terms &other)
+        {
+            middlegame += other.middlegame;
+            endgame += other.endgame;
+            phase += other.phase;
+            return *this;
+        }
+        Terms &operator-=(const Terms &other)
+        {
+            middlegame -= other.middlegame;
+            endgame -= other.endgame;
+            phase -= other.phase;
+            return *this;
+        }
+        bool operator==(const Terms &other) const = default;
+    };
+
+    // material in pawns indexed by Types::PieceType, the defaults of the
+    // evaluation and the fixed values move ordering and SEE work with
+    static constexpr std::array<float, Types::PIECE_TYPE_COUNT> PIECE_VALUES = {
+        1.0f, // pawn
+        5.0f, // rook
+        2.5f, // talia
+        3.5f, // khan
+        3.0f, // mongol
+        2.0f, // camel
+        4.0f, // giraffe
+        1.5f, // elephant
+        2.0f, // war engine
+        1.5f, // vizier
+        1.5f  // admin
+    };
+
+    // weight of each piece in the game phase, the full starting set is
+    // MAX_PHASE and the position counts as a pure endgame at 0
+    static constexpr std::array<int, Types::PIECE_TYPE_COUNT> PHASE_WEIGHTS = {
+        0, // pawn
+        4, // rook
+        2, // talia
+        0, // khan
+        2, // mongol
+        2, // camel
+        4, // giraffe
+        1, // elephant
+        1, // war engine
+        1, // vizier
+        1  // admin
+    };
+    static constexpr int MAX_PHASE = 68;
+
+    // the tunable evaluation weights, in pawns. Defaults are the hand picked
+    // values, a parameter file written by Tamerlane-Texel-Tuner overrides them
+    struct Weights
+    {
+        std::array<float, Types::PIECE_TYPE_COUNT> material = PIECE_VALUES;
+        // per pseudo-legal move, indexed by Types::PieceType
+        std::array<float, Types::PIECE_TYPE_COUNT> mobility = {
+            0.1f, 0.15f, 0.135f, 0.11f, 0.14f, 0.13f, 0.15f, 0.13f, 0.14f, 0.1f, 0.1f};
+        float doubledPawn = -0.5f;
+        float isolatedPawn = -0.3f;
+        float pawnChain = 0.2f;
+        float pawnShield = 0.5f;
+        float khanDefender = 0.2f;
+        float khanAttacker = -0.3f;
+        // on top of khanAttacker for rooks, giraffes and elephants
+        float khanHeavyAttacker = -0.2f;
+        // on top of khanAttacker for mongols, camels and war engines
+        float khanLightAttacker = -0.15f;
+
+        bool operator==(const Weights &other) const = default;
+    };
+
+    static constexpr const char *DEFAULT_WEIGHTS_PATH = "eval.params";
+
+    // the weights are per thread, a thread starts out with the defaults.
+    // Boards built before a change keep stale running sums, rescan them
+    // with Chessboard::setBoard
+    static const Weights &weights();
+    static void setWeights(const Weights &newWeights);
+    // "name value" lines, unknown names fail the load
+    static bool loadWeights(const std::string &path);
+    static bool saveWeights(const std::string &path, const Weights &toSave);
+    // every weight by name, for the parameter file and the tuner
+    static std::vector<std::pair<std::string, float *>> parameters(Weights &target);
+
+    static float pieceValue(const Types::Piece &piece)
+    {
+        Types::PieceType type = piece.type();
+        return type == Types::PieceType::None ? 0.0f
+                                              : PIECE_VALUES[static_cast<size_t>(type)];
+    }
+
+    // contribution of `piece` standing on (col, row), empty squares give 0
+    static Terms pieceSquareTerms(const Types::Piece &piece, int col, int row);
+    // full rescan of the board, what the running sums must always equal
+    static Terms staticTerms(const Types::Board &board);
+    // interpolates between the middlegame and endgame sums by phase
+    static int taper(const Terms &terms);
+    // pseudo-legal move count of the piece on (col, row) under the standard
+    // rules, own pieces block but checks are not looked at
+    static int mobility(const Types::Board &board, int col, int row);
+};
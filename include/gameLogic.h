@@ -10,8 +10,12 @@ class GameLogic
 public:
     void findAndSetKingPosition(Types::Coord &kingPosition, const char &player);
     void promotePawns(char player);
+    // a move as the game plays it without a window: the piece moves, pawns
+    // promote and the pawn of pawns forks where it can
+    void playMove(const Types::Turn &move);
     void checkPawnForks(char player);
     bool isKingInCheck(const char &player, const Types::Board &boardState, bool alt);
+    bool attacksSquare(const Types::Board &boardState, Types::Coord from, Types::Coord to, bool alt);
     bool hasLegalMoves(char player, bool alt);
     bool canDraw(char player);
     bool checkThreefoldRepetition(const Types::Board &boardState, char playerToMove);
@@ -24,4 +28,22 @@ public:
                                                const Types::Piece &piece,
                                                char player,
                                                bool alt);
+
+    // rule set and side resolved at compile time, the overloads above
+    // dispatch to these, instantiated for both of each in gameLogic.cpp
+    template <bool Alt, char Player>
+    bool isKingInCheck(const Types::Board &boardState);
+    // the side is the colour of the piece on `from`
+    template <bool Alt>
+    bool attacksSquare(const Types::Board &boardState, Types::Coord from, Types::Coord to);
+    template <bool Alt, char Player>
+    bool hasLegalMoves();
+    template <bool Alt, char Player>
+    std::vector<std::pair<Types::Piece, std::vector<Types::Coord>>> getAllMoves();
+    template <bool Alt, char Player>
+    std::vector<Types::Coord> getMoves(Types::Coord coord, Types::Piece piece);
+    template <bool Alt, char Player>
+    std::vector<Types::Coord> filterLegalMoves(const std::vector<Types::Coord> &possibleMoves,
+                                               const Types::Coord &fromCoord,
+                                               const Types::Piece &piece);
 };
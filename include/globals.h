@@ -1,5 +1,8 @@
 // Copyright 2024. mirror-shades. GPL-2.0 License.
 #pragma once
 #include "chessboard.h"
+#include "ai.h"
 
-extern Chessboard chessboard;
+// one board per thread so tools can search or generate positions in parallel
+extern thread_local Chessboard chessboard;
+extern AI ai;
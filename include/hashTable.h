@@ -0,0 +1,12 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+
+// slots for a hash table asked to hold wanted entries, rounded down to a
+// power of two so the index is a mask of the key
+inline size_t hashTableSize(size_t wanted)
+{
+    return std::bit_floor(std::max<size_t>(1, wanted));
+}
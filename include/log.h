@@ -0,0 +1,109 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+#include <streambuf>
+#include <string_view>
+
+// levelled logging that never blocks the caller. LOG_INFO("moved " << piece)
+// formats the line into a fixed buffer on the calling thread and hands it
+// to a lock-free queue, a background thread writes the queue out, Debug and
+// Info to stdout and Warning and Error to stderr. When the queue is full
+// the line is dropped and counted instead of waiting.
+//
+// Lines below TAMERLANE_LOG_LEVEL (0 Debug, 1 Info, 2 Warning, 3 Error,
+// default Info, cmake -DTAMERLANE_LOG_LEVEL=0 for debug lines) are compiled
+// out, Log::setLevel raises the bar at runtime
+#ifndef TAMERLANE_LOG_LEVEL
+#define TAMERLANE_LOG_LEVEL 1
+#endif
+
+class Log
+{
+public:
+    enum class Level
+    {
+        Debug,
+        Info,
+        Warning,
+        Error
+    };
+
+    // longest line kept, longer ones are cut, records aside
+    static constexpr size_t MESSAGE_SIZE = 240;
+    static constexpr size_t QUEUE_SIZE = 1024;
+
+    static bool enabled(Level level)
+    {
+        return static_cast<int>(level) >= minimumLevel.load(std::memory_order_relaxed);
+    }
+    static void setLevel(Level level)
+    {
+        minimumLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+    static Level level() { return static_cast<Level>(minimumLevel.load()); }
+    // debug, info, warning or error
+    static bool parseLevel(std::string_view name, Level &level);
+    // a whole line for stderr whatever the level, for machine-readable
+    // records like the --search-stats JSON. It is not cut at MESSAGE_SIZE
+    static void record(std::string_view text);
+    // waits until everything logged so far has been written
+    static void flush();
+
+    // one line being formatted, queued when it goes out of scope
+    class Line
+    {
+    public:
+        explicit Line(Level lineLevel);
+        ~Line();
+        Line(const Line &) = delete;
+        Line &operator=(const Line &) = delete;
+
+        template <typename T>
+        Line &operator<<(const T &value)
+        {
+            stream << value;
+            return *this;
+        }
+
+    private:
+        // writes into text and quietly stops at the end of it
+        class Buffer : public std::streambuf
+        {
+        public:
+            Buffer(char *begin, size_t size) { setp(begin, begin + size); }
+            size_t length() const { return static_cast<size_t>(pptr() - pbase()); }
+
+        protected:
+            int overflow(int) override { return traits_type::eof(); }
+        };
+
+        Level level;
+        char text[MESSAGE_SIZE];
+        Buffer buffer;
+        std::ostream stream;
+    };
+
+private:
+    static void push(Level level, const char *text, size_t length);
+    static inline std::atomic<int> minimumLevel{TAMERLANE_LOG_LEVEL};
+};
+
+#define TAMERLANE_LOG(level, message)                                  \
+    do                                                                 \
+    {                                                                  \
+        if constexpr (static_cast<int>(level) >= TAMERLANE_LOG_LEVEL) \
+        {                                                              \
+            if (Log::enabled(level))                                   \
+            {                                                          \
+                Log::Line logLine(level);                              \
+                logLine << message;                                    \
+            }                                                          \
+        }                                                              \
+    } while (0)
+
+#define LOG_DEBUG(message) TAMERLANE_LOG(Log::Level::Debug, message)
+#define LOG_INFO(message) TAMERLANE_LOG(Log::Level::Info, message)
+#define LOG_WARNING(message) TAMERLANE_LOG(Log::Level::Warning, message)
+#define LOG_ERROR(message) TAMERLANE_LOG(Log::Level::Error, message)
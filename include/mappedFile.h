@@ -0,0 +1,29 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#pragma once
+#include <cstddef>
+#include <string>
+
+// read-only memory mapping of a whole file, mmap on POSIX and a file
+// mapping view on Windows. The data stays valid until close or destruction
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const { return mapping != nullptr; }
+    const void *data() const { return mapping; }
+    size_t size() const { return mappingSize; }
+
+private:
+    void *mapping = nullptr;
+    size_t mappingSize = 0;
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,94 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "types.h"
+
+// efficiently updatable neural network evaluation. The inputs are one
+// feature per colour, piece kind and square, every pawn variant being a kind
+// of its own. The first layer sums the weights of the features on the board
+// into an accumulator that Chessboard::setCell keeps up to date, the rest of
+// the network runs on it in integers:
+//
+//   accumulator (int16, HIDDEN) -> clip [0, 127] -> int8 dense (HIDDEN2)
+//   -> shift, clip [0, 127] -> int8 dense -> white-relative score
+//
+// The forward pass has an AVX2 version picked at runtime on CPUs that have
+// it and a scalar one that gives the same result everywhere else
+class Nnue
+{
+public:
+    static constexpr int SQUARES = 110;
+    // the ten non-pawn piece types, the pawns of each of them and the pawn
+    // of pawns in all its stages
+    static constexpr int PIECE_KINDS = 21;
+    static constexpr int FEATURES = 2 * PIECE_KINDS * SQUARES;
+    static constexpr int HIDDEN = 128;
+    static constexpr int HIDDEN2 = 32;
+    static constexpr int ACTIVATION_MAX = 127;
+    // the second layer's sums are shifted down by this before clipping
+    static constexpr int HIDDEN_SHIFT = 6;
+    // network output per pawn
+    static constexpr int OUTPUT_SCALE = 200;
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t features;
+        uint32_t hidden;
+        uint32_t hidden2;
+        uint32_t padding;
+    };
+
+    // weights in the order the file stores them, after the header and in
+    // the host's byte order
+    struct Network
+    {
+        alignas(32) std::array<int16_t, HIDDEN> featureBiases;
+        alignas(32) std::array<std::array<int16_t, HIDDEN>, FEATURES> featureWeights;
+        alignas(32) std::array<std::array<int8_t, HIDDEN>, HIDDEN2> hiddenWeights;
+        alignas(32) std::array<int32_t, HIDDEN2> hiddenBiases;
+        alignas(32) std::array<int8_t, HIDDEN2> outputWeights;
+        int32_t outputBias;
+    };
+
+    struct Accumulator
+    {
+        alignas(32) std::array<int16_t, HIDDEN> values{};
+
+        bool operator==(const Accumulator &other) const = default;
+    };
+
+    static constexpr const char *MAGIC = "TNNUE01";
+    static constexpr const char *DEFAULT_PATH = "eval.nnue";
+
+    // boards set up before a network is loaded hold stale accumulators,
+    // rescan them with Chessboard::setBoard
+    static bool load(const std::string &path);
+    static void setNetwork(std::unique_ptr<Network> network);
+    static bool isLoaded() { return active != nullptr; }
+    static bool write(const std::string &path, const Network &network);
+    // counts every piece on the board at its material value, a starting
+    // point for training that evaluates exactly like PIECE_VALUES
+    static std::unique_ptr<Network> materialNetwork();
+
+    // feature of `piece` standing on (col, row), -1 for empty squares
+    static int feature(const Types::Piece &piece, int col, int row);
+    static void refresh(const Types::Board &board, Accumulator &accumulator);
+    static void addFeature(Accumulator &accumulator, int feature);
+    static void removeFeature(Accumulator &accumulator, int feature);
+
+    // white-relative score in pawns, with the fastest forward pass the
+    // CPU supports
+    static float evaluate(const Accumulator &accumulator);
+    // raw network outputs of either forward pass, for testing and benchmarks
+    static int32_t forwardScalar(const Accumulator &accumulator);
+    static int32_t forwardSimd(const Accumulator &accumulator);
+    static bool simdAvailable();
+
+private:
+    static const Network *active;
+};
@@ -0,0 +1,55 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "types.h"
+
+// one line text positions, the FEN of this board:
+//
+//   <rows> <side> <rules> <fortress> <turn>
+//
+// rows are the ten board rows from black's back row down to white's,
+// split by '/'. A piece is its two character code with the colour in the
+// case of the first character, white upper ("Rk", "PR", "K0", "Px") and
+// black lower ("rk", "pR", "k0", "px"), and runs of empty squares are
+// counted 1 to 11. side is 'w' or 'b', rules 's' for standard or 'a' for
+// alt, fortress '-' or the colours whose Khan has entered a fortress ("w",
+// "b" or "wb") and turn the game turn, 1 before the first move. The
+// fields after the side may be left off and take those defaults.
+//
+// Parsing and writing work in place without allocating, so millions of
+// positions can be loaded at once
+class Notation
+{
+public:
+    struct Position
+    {
+        Types::Board board;
+        char sideToMove = 'w';
+        bool alt = false;
+        bool whiteInFortress = false;
+        bool blackInFortress = false;
+        int turn = 1;
+    };
+
+    // longest text write produces, a turn of up to nine digits included
+    static constexpr size_t MAX_LENGTH = 256;
+
+    static constexpr const char *MASCULINE =
+        "el1ca1we1we1ca1el/rkmotagivikaadgitamork/pRpMpTpGpVpKpApEpCpWp0/11/11/11/11/"
+        "P0PWPCPEPAPKPVPGPTPMPR/RkMoTaGiAdKaViGiTaMoRk/El1Ca1We1We1Ca1El w s - 1";
+    static constexpr const char *FEMININE =
+        "el1ca1vikaad1ca1el/rkmotagiwepKwegitamork/pRpMpTpGpV1pApEpCpWp0/11/11/11/11/"
+        "P0PWPCPEPA1PVPGPTPMPR/RkMoTaGiWePKWeGiTaMoRk/El1Ca1AdKaVi1Ca1El w s - 1";
+    static constexpr const char *THIRD =
+        "el1ca1vikaad1ca1el/rkmowetagipKgitawemork/pRpMpTpGpV1pApEpCpWp0/11/11/11/11/"
+        "P0PWPCPEPA1PVPGPTPMPR/RkMoWeTaGiPKGiTaWeMoRk/El1Ca1AdKaVi1Ca1El w s - 1";
+
+    // false when the text is malformed, the position is then left half set
+    static bool parse(std::string_view text, Position &position);
+    // writes the text without a terminating null and returns its length, or
+    // 0 when the buffer is shorter than MAX_LENGTH
+    static size_t write(const Position &position, char *buffer, size_t size);
+    static std::string toString(const Position &position);
+};
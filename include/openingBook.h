@@ -0,0 +1,60 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "types.h"
+#include "mappedFile.h"
+
+// binary opening book built from the games archive by Tamerlane-Book-Builder.
+// The file is a header followed by fixed size entries sorted by position key
+// then move, it is memory mapped and searched in place. Entries are written
+// in the host's byte order
+class OpeningBook
+{
+public:
+    struct Header
+    {
+        char magic[8];
+        uint64_t count;
+    };
+
+    struct Entry
+    {
+        uint64_t key; // Zobrist::hash of the position before the move
+        // results of the games the move was played in, for the side moving
+        uint32_t wins;
+        uint32_t draws;
+        uint32_t losses;
+        // chance of being picked relative to the other moves of the position
+        uint16_t weight;
+        int8_t fromX;
+        int8_t fromY;
+        int8_t toX;
+        int8_t toY;
+        uint8_t padding[2];
+    };
+
+    static constexpr const char *MAGIC = "TBOOK01";
+    static constexpr const char *DEFAULT_PATH = "games/book.bin";
+
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const { return entries != nullptr; }
+    size_t size() const { return count; }
+
+    // all moves stored for a position, empty when it's out of book
+    std::vector<Entry> probe(uint64_t key) const;
+
+    // sorts the entries and writes them as a book file
+    static bool write(const std::string &path, std::vector<Entry> bookEntries);
+
+private:
+    MappedFile file;
+    const Entry *entries = nullptr;
+    size_t count = 0;
+};
+
+static_assert(sizeof(OpeningBook::Header) == 16, "book header layout changed");
+static_assert(sizeof(OpeningBook::Entry) == 32, "book entry layout changed");
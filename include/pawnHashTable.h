@@ -0,0 +1,31 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// direct mapped cache of pawn structure scores keyed by the pawn-only
+// zobrist key of the board. The structure changes far less often than the
+// rest of the position so nearly every leaf finds its pawns here. An empty
+// slot has key 0 and score 0, which is also right for a board without pawns
+class PawnHashTable
+{
+public:
+    struct Entry
+    {
+        uint64_t key = 0;
+        float score = 0.0f;
+    };
+
+    explicit PawnHashTable(size_t entryCount = DEFAULT_ENTRIES);
+    void clear();
+    bool probe(uint64_t key, float &score) const;
+    void store(uint64_t key, float score);
+    size_t size() const { return entries.size(); }
+
+    static constexpr size_t DEFAULT_ENTRIES = 1 << 14;
+
+private:
+    std::vector<Entry> entries;
+    size_t mask = 0;
+};
@@ -36,21 +36,39 @@ public:
         return dirs;
     }();
 
-    std::vector<Types::Coord> getPawnMoves(Types::Coord coord, char player);
-    std::vector<Types::Coord> getRookMoves(Types::Coord coord, char player);
-    std::vector<Types::Coord> getTaliaMoves(Types::Coord coord, char player);
-    std::vector<Types::Coord> getElephantMoves(Types::Coord coord, char player);
-    std::vector<Types::Coord> getVizierMoves(Types::Coord coord, char player);
-    std::vector<Types::Coord> getKhanMoves(Types::Coord coord, char player);
-    std::vector<Types::Coord> getWarEngineMoves(Types::Coord coord, char player);
-    std::vector<Types::Coord> getAdminMoves(Types::Coord coord, char player);
-    std::vector<Types::Coord> getMongolMoves(Types::Coord coord, char player);
-    std::vector<Types::Coord> getCamelMoves(Types::Coord coord, char player);
-    std::vector<Types::Coord> getGiraffeMoves(Types::Coord coord, char player);
+    // the side to move is a template parameter, both sides are
+    // instantiated in pieceLogic.cpp
+    template <char Player>
+    std::vector<Types::Coord> getPawnMoves(Types::Coord coord);
+    template <char Player>
+    std::vector<Types::Coord> getRookMoves(Types::Coord coord);
+    template <char Player>
+    std::vector<Types::Coord> getTaliaMoves(Types::Coord coord);
+    template <char Player>
+    std::vector<Types::Coord> getElephantMoves(Types::Coord coord);
+    template <char Player>
+    std::vector<Types::Coord> getVizierMoves(Types::Coord coord);
+    template <char Player>
+    std::vector<Types::Coord> getKhanMoves(Types::Coord coord);
+    template <char Player>
+    std::vector<Types::Coord> getWarEngineMoves(Types::Coord coord);
+    template <char Player>
+    std::vector<Types::Coord> getAdminMoves(Types::Coord coord);
+    template <char Player>
+    std::vector<Types::Coord> getMongolMoves(Types::Coord coord);
+    template <char Player>
+    std::vector<Types::Coord> getCamelMoves(Types::Coord coord);
+    template <char Player>
+    std::vector<Types::Coord> getGiraffeMoves(Types::Coord coord);
 
-    std::vector<Types::Coord> getAltWarEngineMoves(Types::Coord coord, char player);
-    std::vector<Types::Coord> getAltElephantMoves(Types::Coord coord, char player);
-    std::vector<Types::Coord> getAltAdminMoves(Types::Coord coord, char player);
-    std::vector<Types::Coord> getAltVizierMoves(Types::Coord coord, char player);
-    std::vector<Types::Coord> getAltPawnMoves(Types::Coord coord, char player);
+    template <char Player>
+    std::vector<Types::Coord> getAltWarEngineMoves(Types::Coord coord);
+    template <char Player>
+    std::vector<Types::Coord> getAltElephantMoves(Types::Coord coord);
+    template <char Player>
+    std::vector<Types::Coord> getAltAdminMoves(Types::Coord coord);
+    template <char Player>
+    std::vector<Types::Coord> getAltVizierMoves(Types::Coord coord);
+    template <char Player>
+    std::vector<Types::Coord> getAltPawnMoves(Types::Coord coord);
 };
@@ -0,0 +1,75 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include "ai.h"
+
+// line based text protocol modelled on UCI, for driving the engine from
+// other programs without a window. Input is read on a thread of its own so
+// `stop` reaches a running search straight away, every other command is
+// queued and handled in order on the thread that called run, whose board
+// and evaluation weights the engine searches with.
+//
+//   uci, isready, ucinewgame, stop, quit, bench [depth]
+//   setoption name <name> value <value>
+//   position <startpos|masculine|feminine|third> [alt] [moves f3f4 ...]
+//   position fen <notation> [moves f3f4 ...]
+//   go [depth n] [nodes n] [movetime ms] [wtime ms] [btime ms]
+//      [winc ms] [binc ms] [infinite]
+//
+// Moves are written from square then to square, files a-k from white's left
+// and ranks 1-10 from white's side. Scores are centipawns for the side to
+// move, positions are given in the text notation of notation.h. Node and
+// time limits cut the search off, `go infinite` holds its bestmove until
+// `stop` or `quit`, and the end of the input counts as `quit`
+class Protocol
+{
+public:
+    explicit Protocol(AI &engine) : ai(engine), options(engine.getOptions()) {}
+    // answers on stdout until `quit` or the end of the input, anything else
+    // the engine logs below warnings is held back meanwhile
+    void run(std::istream &input);
+
+    static std::string squareName(Types::Coord square);
+    static bool parseSquare(const std::string &text, Types::Coord &square);
+    static std::string moveName(const Types::Turn &move);
+
+    static constexpr const char *ENGINE_NAME = "Tamerlane";
+    static constexpr const char *ENGINE_AUTHOR = "mirror-shades";
+
+private:
+    // false once the engine should quit
+    bool handle(const std::string &line);
+    void identify();
+    void setOption(std::istringstream &tokens);
+    void setPosition(std::istringstream &tokens);
+    void go(std::istringstream &tokens);
+    void send(const std::string &line);
+    void push(const std::string &line);
+    // stops the running go and any read before it, wakes a held go infinite
+    void stopSearches();
+
+    AI &ai;
+    Types::SearchOptions options;
+    std::ostream *output = nullptr;
+    std::mutex outputMutex;
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::deque<std::string> queue;
+    // go commands read and started, and the last go a stop or quit was
+    // read after, set under queueMutex
+    std::atomic<int> goQueued{0};
+    std::atomic<int> stoppedThrough{0};
+    int goStarted = 0;
+
+    // the position searched by `go`, already set up on the board
+    char player = 'w';
+    int turn = 1;
+    bool alt = false;
+};
@@ -20,6 +20,7 @@ public:
     void updateAnimations();
     void drawBoard(sf::RenderWindow &window);
     void drawExitButton(sf::RenderWindow &window);
+    void drawSearchStats(sf::RenderWindow &window);
     void winScreen(sf::RenderWindow &window);
     void highlightSquares(sf::RenderWindow &window);
     void highlightPreviousMove(sf::RenderWindow &window);
@@ -36,6 +36,7 @@ public:
     static bool isPieceSelected;
     static bool aiVsAiMode;
     static bool renderNeeded;
+    static bool showSearchStats; // debug overlay with the last search's numbers
     static int currentGameId; 
     static Types::Piece selectedPiece;
     static Types::Coord selectedSquare;
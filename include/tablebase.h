@@ -0,0 +1,105 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "types.h"
+#include "mappedFile.h"
+
+// endgame tablebases for Khan endings without pawns, built by
+// Tamerlane-Tablebase-Gen. A table holds one byte per position of a material
+// set: DRAW, INVALID for impossible positions, or the distance to mate in
+// plies plus one, where an odd distance wins for the side to move and an
+// even one loses. A Khan next to its own fortress can step in and draw, so
+// the side to move there only loses to mate. The index pairs the Khans
+// only where they don't touch and gives no two pieces the same square.
+// Tables are memory mapped and indexed directly
+class Tablebase
+{
+public:
+    // non-Khan piece types of each side in sorted order, "G" and "" is KGvK
+    struct Material
+    {
+        std::string white;
+        std::string black;
+
+        std::string name() const;
+        bool parse(const std::string &name);
+        int pieceCount() const { return 2 + static_cast<int>(white.size() + black.size()); }
+        Material swapped() const { return {black, white}; }
+    };
+
+    enum class Outcome
+    {
+        Draw,
+        Win, // for the side to move
+        Loss
+    };
+
+    struct ProbeResult
+    {
+        Outcome outcome = Outcome::Draw;
+        int distance = 0; // plies to mate, 0 for draws
+    };
+
+    struct Header
+    {
+        char magic[8];
+        char material[16];
+        uint8_t alt;
+        uint8_t pieceCount;
+        uint8_t padding[6];
+        uint64_t count;
+    };
+
+    static constexpr uint8_t DRAW = 0;
+    static constexpr uint8_t INVALID = 255;
+    // distances are stored plus one in a byte next to the two markers
+    static constexpr int MAX_DISTANCE = 252;
+    static constexpr int SQUARES = 110;
+    static constexpr int MAX_PIECES = 4;
+    static constexpr const char *MAGIC = "TTBASE3";
+    // index of a position no table holds, Khans side by side or two pieces
+    // on one square
+    static constexpr uint64_t NO_INDEX = UINT64_MAX;
+    static constexpr const char *DEFAULT_DIRECTORY = "tablebases";
+
+    // maps every table file in the directory, returns how many were loaded
+    int load(const std::string &directory);
+    size_t tableCount() const { return tables.size(); }
+    int maxPieces() const { return largestTable; }
+
+    // looks the position up when it has at most pieceLimit pieces and its
+    // material has a table, the result is for the side to move
+    bool probe(const Types::Board &board, char player, bool alt,
+               ProbeResult &result, int pieceLimit = MAX_PIECES) const;
+
+    // layout shared with the generator. Squares are row * 11 + col and the
+    // pieces go white Khan, black Khan, white pieces, black pieces
+    static uint64_t tableSize(int pieceCount);
+    static uint64_t index(int pieceCount, const int *squares, char player);
+    static void decode(uint64_t index, int pieceCount, int *squares, char &player);
+    static std::vector<Types::Piece> tablePieces(const Material &material);
+    static std::string fileName(const Material &material, bool alt);
+    static bool write(const std::string &path, const Material &material, bool alt,
+                      const std::vector<uint8_t> &values);
+    static ProbeResult decodeValue(uint8_t value);
+    // false when the position has pawns, extra Khans or more than pieceLimit pieces
+    static bool materialOf(const Types::Board &board, Material &material,
+                           int pieceLimit = MAX_PIECES);
+
+private:
+    struct Table
+    {
+        MappedFile file;
+        const uint8_t *values = nullptr;
+    };
+
+    std::map<std::string, std::unique_ptr<Table>> tables; // keyed by file name
+    int largestTable = 0;
+};
+
+static_assert(sizeof(Tablebase::Header) == 40, "tablebase header layout changed");
@@ -0,0 +1,109 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// scoped zone profiler. TRACE_ZONE("name") times the rest of the enclosing
+// scope and keeps it in a ring buffer owned by the calling thread, so
+// recording never takes a lock. Trace::write saves the zones of every
+// thread in the Chrome trace event format, for chrome://tracing or
+// ui.perfetto.dev.
+//
+// The macros only expand to anything when TAMERLANE_TRACING is defined
+// (cmake -DTAMERLANE_TRACING=ON), zone names must be string literals
+class Trace
+{
+public:
+    // zones kept per thread, once full the oldest are overwritten
+    static constexpr size_t BUFFER_EVENTS = size_t(1) << 16;
+
+    struct Event
+    {
+        const char *name;
+        // in now() ticks, converted to time when written out
+        int64_t start;
+        int64_t duration;
+    };
+
+    class Zone
+    {
+    public:
+        explicit Zone(const char *zoneName) : name(zoneName), start(now()) {}
+        ~Zone() { record(name, start, now() - start); }
+        Zone(const Zone &) = delete;
+        Zone &operator=(const Zone &) = delete;
+
+    private:
+        const char *name;
+        int64_t start;
+    };
+
+    // the time stamp counter on x86, a clock read costs several times more
+    // in some virtual machines. Elsewhere steady clock nanoseconds
+    static int64_t now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return static_cast<int64_t>(__rdtsc());
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+#endif
+    }
+    static void record(const char *name, int64_t start, int64_t duration)
+    {
+        Buffer *buffer = localBuffer ? localBuffer : registerThread();
+        uint64_t index = buffer->written.load(std::memory_order_relaxed);
+        buffer->events[index & (BUFFER_EVENTS - 1)] = {name, start, duration};
+        buffer->written.store(index + 1, std::memory_order_release);
+    }
+    // shown for the calling thread's zones in the trace viewer
+    static void setThreadName(const char *name);
+    // false when the file cannot be written or tracing is compiled out
+    static bool write(const std::string &path);
+
+    static constexpr bool compiledIn()
+    {
+#ifdef TAMERLANE_TRACING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+private:
+    // written by its own thread only, the count is published after the
+    // event so a reader never sees a slot before it is filled
+    struct Buffer
+    {
+        std::unique_ptr<Event[]> events{new Event[BUFFER_EVENTS]};
+        std::atomic<uint64_t> written{0};
+        int threadId = 0;
+        std::string threadName;
+    };
+
+    static Buffer *registerThread();
+    static inline thread_local Buffer *localBuffer = nullptr;
+    // buffers outlive their threads so worker zones still reach the file
+    static std::mutex registryMutex;
+    static std::vector<std::shared_ptr<Buffer>> registry;
+};
+
+#ifdef TAMERLANE_TRACING
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_ZONE(name) Trace::Zone TRACE_CONCAT(traceZone, __LINE__)(name)
+#define TRACE_THREAD(name) Trace::setThreadName(name)
+#else
+#define TRACE_ZONE(name) ((void)0)
+#define TRACE_THREAD(name) ((void)0)
+#endif
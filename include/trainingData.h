@@ -0,0 +1,115 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include "types.h"
+#include "mappedFile.h"
+
+// binary training positions written by Tamerlane-Self-Play. The file is a
+// header followed by chunks of up to CHUNK_RECORDS fixed size records, each
+// chunk led by its record count and a checksum of the records, so a file
+// cut short or damaged mid-write only loses the chunks it touched. Records
+// are written in the host's byte order
+class TrainingData
+{
+public:
+    static constexpr int MAX_PIECES = 56;
+    static constexpr int OCCUPANCY_BYTES = 14;
+    static constexpr size_t CHUNK_RECORDS = 4096;
+
+    struct Header
+    {
+        char magic[8];
+        uint64_t reserved;
+    };
+
+    struct ChunkHeader
+    {
+        char magic[4];
+        uint32_t count;
+        uint32_t checksum;
+        uint32_t padding;
+    };
+
+    struct Record
+    {
+        // bit per square row by row, set where a piece stands
+        uint8_t occupancy[OCCUPANCY_BYTES];
+        char sideToMove;
+        // white's result: 1 win, 0 draw, -1 loss
+        int8_t result;
+        // the pieces of the occupied squares in square order, see pack
+        uint8_t pieces[MAX_PIECES];
+        // white-relative search score in hundredths of a pawn
+        int16_t score;
+        uint16_t ply;
+    };
+
+    static constexpr const char *MAGIC = "TDATA01";
+    static constexpr const char *CHUNK_MAGIC = "CHNK";
+    static constexpr const char *DEFAULT_PATH = "games/selfplay.bin";
+
+    // false for boards with more pieces or piece codes than a record holds
+    static bool pack(const Types::Board &board, char sideToMove, Record &record);
+    static Types::Board unpack(const Record &record);
+    static uint32_t checksum(const Record *records, size_t count);
+
+    // appends to a file from any number of threads, every full chunk is
+    // written out straight away
+    class Writer
+    {
+    public:
+        ~Writer() { close(); }
+        // an existing file is cut back to its last intact chunk and
+        // appended to
+        bool open(const std::string &path);
+        void write(const std::vector<Record> &records);
+        // writes the last, partly filled chunk
+        void close();
+        size_t written() const { return recordsWritten; }
+
+    private:
+        void writeChunk(const Record *records, size_t count);
+
+        std::mutex mutex;
+        std::ofstream file;
+        std::vector<Record> pending;
+        size_t recordsWritten = 0;
+    };
+
+    // memory maps a file and indexes its intact chunks, records are read in
+    // place so files larger than memory can be sampled
+    class Reader
+    {
+    public:
+        bool open(const std::string &path);
+        size_t size() const { return recordCount; }
+        // bytes up to the end of the last intact chunk
+        size_t validBytes() const { return validLength; }
+        const Record &operator[](size_t index) const;
+        // `count` records picked uniformly at random, with replacement
+        std::vector<Record> sample(size_t count, std::mt19937 &rng) const;
+
+    private:
+        struct Chunk
+        {
+            const Record *records;
+            size_t firstIndex;
+            size_t count;
+        };
+
+        MappedFile file;
+        std::vector<Chunk> chunks;
+        size_t recordCount = 0;
+        size_t validLength = 0;
+    };
+};
+
+static_assert(sizeof(TrainingData::Header) == 16, "training data header layout changed");
+static_assert(sizeof(TrainingData::ChunkHeader) == 16, "training data chunk layout changed");
+static_assert(sizeof(TrainingData::Record) == 76, "training data record layout changed");
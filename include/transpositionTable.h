@@ -0,0 +1,51 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "types.h"
+
+// fixed size hash table of searched positions indexed by zobrist key.
+// Scores are white-relative like the rest of the search
+class TranspositionTable
+{
+public:
+    enum class Bound : uint8_t
+    {
+        None,
+        Exact,
+        Lower, // search failed high, real score is at least this
+        Upper  // search failed low, real score is at most this
+    };
+
+    struct Entry
+    {
+        uint64_t key = 0;
+        float score = 0.0f;
+        int16_t depth = -1;
+        Bound bound = Bound::None;
+        uint8_t generation = 0;
+        // best move found, from == to when there is none
+        int8_t fromX = 0;
+        int8_t fromY = 0;
+        int8_t toX = 0;
+        int8_t toY = 0;
+
+        bool hasMove() const { return fromX != toX || fromY != toY; }
+    };
+
+    explicit TranspositionTable(size_t sizeMb = 16);
+    void resize(size_t sizeMb);
+    void clear();
+    // ages the entries of earlier searches so they get replaced first
+    void newSearch() { ++generation; }
+    bool probe(uint64_t key, Entry &entry) const;
+    void store(uint64_t key, int depth, float score, Bound bound,
+               const Types::Turn *bestMove);
+    size_t size() const { return entries.size(); }
+
+private:
+    std::vector<Entry> entries;
+    size_t mask = 0;
+    uint8_t generation = 0;
+};
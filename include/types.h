@@ -4,9 +4,56 @@
 #include <cstring>
 #include <array>
 #include <vector>
+#include <cstdint>
 
 namespace Types
 {
+    // compact id of a piece type, indexes the per-type tables used by move
+    // generation, attack detection and evaluation. All Khan variants share
+    // Khan, None covers empty squares and anything unknown
+    enum class PieceType : uint8_t
+    {
+        Pawn,
+        Rook,
+        Talia,
+        Khan,
+        Mongol,
+        Camel,
+        Giraffe,
+        Elephant,
+        WarEngine,
+        Vizier,
+        Admin,
+        None
+    };
+    constexpr size_t PIECE_TYPE_COUNT = static_cast<size_t>(PieceType::None);
+
+    // type character of a piece code ('R' in "wRk") to its PieceType
+    constexpr std::array<PieceType, 128> PIECE_TYPE_TABLE = []()
+    {
+        std::array<PieceType, 128> table{};
+        table.fill(PieceType::None);
+        table['p'] = PieceType::Pawn;
+        table['R'] = PieceType::Rook;
+        table['T'] = PieceType::Talia;
+        table['K'] = PieceType::Khan;
+        table['M'] = PieceType::Mongol;
+        table['C'] = PieceType::Camel;
+        table['G'] = PieceType::Giraffe;
+        table['E'] = PieceType::Elephant;
+        table['W'] = PieceType::WarEngine;
+        table['V'] = PieceType::Vizier;
+        table['A'] = PieceType::Admin;
+        return table;
+    }();
+
+    constexpr PieceType pieceTypeOf(char type)
+    {
+        return static_cast<unsigned char>(type) < PIECE_TYPE_TABLE.size()
+                   ? PIECE_TYPE_TABLE[static_cast<unsigned char>(type)]
+                   : PieceType::None;
+    }
+
     // this used to be a string, but I changed it to a char array to avoid global string issues
     // this is a 3 character code for the piece, followed by a null terminator
     // all pieces are 3 length including empty space "---" so length can be hardcoded
@@ -60,6 +107,7 @@ namespace Types
         char color() const { return code[0]; }
         char piece() const { return code[1]; }
         char variant() const { return code[2]; }
+        PieceType type() const { return pieceTypeOf(code[1]); }
     };
 
     struct Coord
@@ -113,4 +161,84 @@ namespace Types
     {
         std::array<std::array<Piece, 11>, 10> board;
     };
+
+    // search features that can be toggled for self-play A/B testing
+    struct SearchOptions
+    {
+        bool nullMovePruning = true;
+        // depth taken off the null move search on top of the normal ply
+        int nullMoveReduction = 2;
+        bool lateMoveReductions = true;
+        // moves searched at full depth before reductions kick in
+        int lateMoveFullDepthMoves = 3;
+        // reduction = base + log(depth) * log(moveNumber) / divisor
+        float lateMoveBase = 0.75f;
+        float lateMoveDivisor = 2.25f;
+        // a search that has spent this many nodes is cut off and plays the
+        // best move of its last finished iteration, 0 lets it run
+        long long nodeLimit = 0;
+        // a search running this many milliseconds is cut off and plays the
+        // best move of its last finished iteration, 0 lets it run
+        long long timeLimitMs = 0;
+        // transposition table size in megabytes
+        int hashSizeMb = 16;
+        // evaluation cache size in megabytes, 0 turns the cache off
+        int evalCacheSizeMb = 4;
+        // print a JSON line per iteration and per search to stderr
+        bool searchStatsJson = false;
+        // reproducible searches, tied moves are broken by move order and the
+        // transposition table starts empty every search
+        bool deterministic = false;
+        // seed for the tie-break generator, 0 seeds from std::random_device
+        unsigned int seed = 0;
+        // play moves from the opening book when one is loaded
+        bool useOpeningBook = true;
+        // look up endings with at most this many pieces in the tablebases
+        bool useTablebases = true;
+        int tablebasePieces = 4;
+        // evaluate with the NNUE network instead of the hand written terms
+        // when one is loaded
+        bool useNnue = true;
+    };
+
+    // figures for one iteration of the iterative deepening loop
+    struct IterationStats
+    {
+        int depth = 0;
+        float score = 0.0f;
+        // search and quiescence nodes spent on this iteration alone
+        long long nodes = 0;
+        double seconds = 0.0;
+    };
+
+    // what the last AI::minMax call did, for tuning by the numbers
+    struct SearchStats
+    {
+        long long nodes = 0;
+        long long quiescenceNodes = 0;
+        double seconds = 0.0;
+        double nodesPerSecond = 0.0;
+        // node count of the last iteration over the one before it
+        double effectiveBranchingFactor = 0.0;
+        long long ttProbes = 0;
+        long long ttHits = 0;
+        long long ttCutoffs = 0;
+        long long tablebaseHits = 0;
+        long long pawnHashProbes = 0;
+        long long pawnHashHits = 0;
+        long long evalCacheProbes = 0;
+        long long evalCacheHits = 0;
+        long long betaCutoffs = 0;
+        // cutoffs produced by the first move searched, a move ordering gauge
+        long long firstMoveCutoffs = 0;
+        double firstMoveCutoffRate = 0.0;
+        int depth = 0;
+        // deepest ply reached including quiescence
+        int selectiveDepth = 0;
+        std::vector<IterationStats> iterations;
+        // the move came from the opening book, nothing was searched
+        bool bookMove = false;
+        // the last iteration was cut off by AI::stop or the time limit
+        bool stopped = false;
+    };
 }
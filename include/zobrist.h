@@ -0,0 +1,22 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#pragma once
+#include <cstdint>
+#include "types.h"
+
+// zobrist hashing of board positions. Piece keys are mixed from the square
+// and the full three character code, so every pawn variant hashes apart
+// without a table of all piece codes
+class Zobrist
+{
+public:
+    static uint64_t hash(const Types::Board &board, char player, bool alt);
+    static uint64_t pieceKey(int row, int col, const Types::Piece &piece);
+    // side to move and rule set part of the key, hash() is the pieces xor this
+    static uint64_t stateKey(char player, bool alt)
+    {
+        return (player == 'b' ? blackToMoveKey : 0) ^ (alt ? altRulesKey : 0);
+    }
+
+    static constexpr uint64_t blackToMoveKey = 0x9e3779b97f4a7c15ULL;
+    static constexpr uint64_t altRulesKey = 0xc2b2ae3d27d4eb4fULL;
+};
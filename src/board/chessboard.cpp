@@ -3,12 +3,14 @@
 #include <iostream>
 #include "globals.h"
 #include "chessboard.h"
+#include "zobrist.h"
 
-Chessboard chessboard;
+thread_local Chessboard chessboard;
 
 void Chessboard::setBoard(const Types::Board &newBoard)
 {
     chessboard = newBoard;
+    rescan();
 }
 
 void Chessboard::resetBoard()
@@ -29,6 +31,7 @@ void Chessboard::setMasculineBoard()
           {"wp0", "wpW", "wpC", "wpE", "wpA", "wpK", "wpV", "wpG", "wpT", "wpM", "wpR"},
           {"wRk", "wMo", "wTa", "wGi", "wAd", "wKa", "wVi", "wGi", "wTa", "wMo", "wRk"},
           {"wEl", "---", "wCa", "---", "wWe", "---", "wWe", "---", "wCa", "---", "wEl"}}};
+    rescan();
 }
 
 void Chessboard::setFeminineBoard()
@@ -44,6 +47,7 @@ void Chessboard::setFeminineBoard()
           {"wp0", "wpW", "wpC", "wpE", "wpA", "---", "wpV", "wpG", "wpT", "wpM", "wpR"},
           {"wRk", "wMo", "wTa", "wGi", "wWe", "wpK", "wWe", "wGi", "wTa", "wMo", "wRk"},
           {"wEl", "---", "wCa", "---", "wAd", "wKa", "wVi", "---", "wCa", "---", "wEl"}}};
+    rescan();
 }
 
 void Chessboard::setThirdBoard()
@@ -59,6 +63,7 @@ void Chessboard::setThirdBoard()
           {"wp0", "wpW", "wpC", "wpE", "wpA", "---", "wpV", "wpG", "wpT", "wpM", "wpR"},
           {"wRk", "wMo", "wWe", "wTa", "wGi", "wpK", "wGi", "wTa", "wWe", "wMo", "wRk"},
           {"wEl", "---", "wCa", "---", "wAd", "wKa", "wVi", "---", "wCa", "---", "wEl"}}};
+    rescan();
 }
 
 const Types::Board &Chessboard::getBoardState() const
@@ -79,8 +84,58 @@ void Chessboard::setCell(Types::Coord coord, const Types::Piece &value)
 {
     if (isValidCoord(coord))
     {
-        chessboard.board[coord.y][coord.x] = value;
+        Types::Piece &cell = chessboard.board[coord.y][coord.x];
+        staticTerms -= Evaluation::pieceSquareTerms(cell, coord.x, coord.y);
+        staticTerms += Evaluation::pieceSquareTerms(value, coord.x, coord.y);
+        if (cell.color() != '-')
+        {
+            uint64_t key = Zobrist::pieceKey(coord.y, coord.x, cell);
+            pieceKey ^= key;
+            if (cell.type() == Types::PieceType::Pawn)
+                pawnKey ^= key;
+        }
+        if (value.color() != '-')
+        {
+            uint64_t key = Zobrist::pieceKey(coord.y, coord.x, value);
+            pieceKey ^= key;
+            if (value.type() == Types::PieceType::Pawn)
+                pawnKey ^= key;
+        }
+        if (Nnue::isLoaded())
+        {
+            int removed = Nnue::feature(cell, coord.x, coord.y);
+            int added = Nnue::feature(value, coord.x, coord.y);
+            if (removed >= 0)
+                Nnue::removeFeature(accumulator, removed);
+            if (added >= 0)
+                Nnue::addFeature(accumulator, added);
+        }
+        cell = value;
+    }
+}
+
+// rebuilds everything setCell keeps up to date after the whole board
+// has been replaced
+void Chessboard::rescan()
+{
+    staticTerms = Evaluation::staticTerms(chessboard);
+    pieceKey = 0;
+    pawnKey = 0;
+    for (int row = 0; row < rows; ++row)
+    {
+        for (int col = 0; col < cols; ++col)
+        {
+            const Types::Piece &piece = chessboard.board[row][col];
+            if (piece.color() == '-')
+                continue;
+            uint64_t key = Zobrist::pieceKey(row, col, piece);
+            pieceKey ^= key;
+            if (piece.type() == Types::PieceType::Pawn)
+                pawnKey ^= key;
+        }
     }
+    if (Nnue::isLoaded())
+        Nnue::refresh(chessboard, accumulator);
 }
 
 bool Chessboard::isValidCoord(Types::Coord coord) const
@@ -105,15 +160,8 @@ Chessboard::Chessboard()
 {
     setMasculineBoard();
 
-    // for testing
-    // chessboard = {{{"---", "---", "---", "---", "---", "---", "---", "---", "wRk", "---", "---"},
-    //                {"---", "---", "---", "---", "---", "---", "---", "---", "---", "---", "---"},
-    //                {"---", "wVi", "---", "---", "---", "---", "---", "---", "---", "---", "---"},
-    //                {"wKa", "---", "---", "---", "---", "---", "---", "---", "---", "wRk", "---"},
-    //                {"---", "---", "---", "---", "---", "---", "---", "---", "---", "---", "---"},
-    //                {"---", "---", "---", "---", "bGi", "---", "---", "---", "---", "---", "---"},
-    //                {"---", "---", "---", "---", "---", "---", "---", "---", "---", "---", "bKa"},
-    //                {"---", "---", "---", "---", "---", "---", "---", "---", "---", "---", "---"},
-    //                {"---", "---", "---", "---", "---", "---", "---", "---", "---", "---", "---"},
-    //                {"---", "---", "---", "---", "---", "---", "---", "---", "---", "---", "---"}}};
+    // for testing, any position can be set up from its notation
+    // Notation::Position position;
+    // Notation::parse("8Rk2/11/1Vi9/Ka8Rk1/11/4gi6/10ka/11/11/11 w", position);
+    // setBoard(position.board);
 }
@@ -4,11 +4,12 @@
 #include "pieceLogic.h"
 #include "globals.h"
 
-std::vector<Types::Coord> PieceLogic::getPawnMoves(Types::Coord coord, char player)
+template <char Player>
+std::vector<Types::Coord> PieceLogic::getPawnMoves(Types::Coord coord)
 {
     std::vector<Types::Coord> moves;
-    int direction = (player == 'w') ? -1 : 1;
-    char enemy = (player == 'w') ? 'b' : 'w';
+    constexpr int direction = (Player == 'w') ? -1 : 1;
+    constexpr char enemy = (Player == 'w') ? 'b' : 'w';
 
     Types::Coord forwardMove = {coord.x, coord.y + direction};
     if (forwardMove.y >= 0 && forwardMove.y < Chessboard::cols &&
@@ -36,10 +37,11 @@ std::vector<Types::Coord> PieceLogic::getPawnMoves(Types::Coord coord, char play
     return moves;
 }
 
-std::vector<Types::Coord> PieceLogic::getRookMoves(Types::Coord coord, char player)
+template <char Player>
+std::vector<Types::Coord> PieceLogic::getRookMoves(Types::Coord coord)
 {
     std::vector<Types::Coord> moves;
-    char enemy = (player == 'w') ? 'b' : 'w';
+    constexpr char enemy = (Player == 'w') ? 'b' : 'w';
 
     // Check all orthogonal directions
     for (const auto &direction : ORTHOGONAL)
@@ -73,10 +75,11 @@ std::vector<Types::Coord> PieceLogic::getRookMoves(Types::Coord coord, char play
     return moves;
 }
 
-std::vector<Types::Coord> PieceLogic::getTaliaMoves(Types::Coord coord, char player)
+template <char Player>
+std::vector<Types::Coord> PieceLogic::getTaliaMoves(Types::Coord coord)
 {
     std::vector<Types::Coord> moves;
-    char enemy = (player == 'w') ? 'b' : 'w';
+    constexpr char enemy = (Player == 'w') ? 'b' : 'w';
 
     // Check all diagonal directions
     for (const auto &direction : DIAGONAL)
@@ -116,7 +119,8 @@ std::vector<Types::Coord> PieceLogic::getTaliaMoves(Types::Coord coord, char pla
     return moves;
 }
 
-std::vector<Types::Coord> PieceLogic::getElephantMoves(Types::Coord coord, char player)
+template <char Player>
+std::vector<Types::Coord> PieceLogic::getElephantMoves(Types::Coord coord)
 {
     std::vector<Types::Coord> moves;
 
@@ -134,7 +138,7 @@ std::vector<Types::Coord> PieceLogic::getElephantMoves(Types::Coord coord, char
     {
         if (move.x >= 0 && move.x <= Chessboard::rows &&
             move.y >= 0 && move.y < Chessboard::cols - 1 &&
-            chessboard.getPiece(move).color() != player)
+            chessboard.getPiece(move).color() != Player)
         {
             moves.push_back(move);
         }
@@ -143,7 +147,8 @@ std::vector<Types::Coord> PieceLogic::getElephantMoves(Types::Coord coord, char
     return moves;
 }
 
-std::vector<Types::Coord> PieceLogic::getVizierMoves(Types::Coord coord, char player)
+template <char Player>
+std::vector<Types::Coord> PieceLogic::getVizierMoves(Types::Coord coord)
 {
     std::vector<Types::Coord> moves;
 
@@ -152,7 +157,7 @@ std::vector<Types::Coord> PieceLogic::getVizierMoves(Types::Coord coord, char pl
         Types::Coord move = {coord.x + direction.x, coord.y + direction.y};
         if (move.x >= 0 && move.x <= Chessboard::rows &&
             move.y >= 0 && move.y < Chessboard::cols - 1 &&
-            chessboard.getPiece(move).color() != player)
+            chessboard.getPiece(move).color() != Player)
         {
             moves.push_back(move);
         }
@@ -161,7 +166,8 @@ std::vector<Types::Coord> PieceLogic::getVizierMoves(Types::Coord coord, char pl
     return moves;
 }
 
-std::vector<Types::Coord> PieceLogic::getKhanMoves(Types::Coord coord, char player)
+template <char Player>
+std::vector<Types::Coord> PieceLogic::getKhanMoves(Types::Coord coord)
 {
     std::vector<Types::Coord> moves;
 
@@ -170,7 +176,7 @@ std::vector<Types::Coord> PieceLogic::getKhanMoves(Types::Coord coord, char play
         Types::Coord move = {coord.x + direction.x, coord.y + direction.y};
         if (move.x >= 0 && move.x <= Chessboard::rows &&
             move.y >= 0 && move.y < Chessboard::cols - 1 &&
-            chessboard.getPiece(move).color() != player)
+            chessboard.getPiece(move).color() != Player)
         {
             moves.push_back(move);
         }
@@ -179,7 +185,8 @@ std::vector<Types::Coord> PieceLogic::getKhanMoves(Types::Coord coord, char play
     return moves;
 }
 
-std::vector<Types::Coord> PieceLogic::getWarEngineMoves(Types::Coord coord, char player)
+template <char Player>
+std::vector<Types::Coord> PieceLogic::getWarEngineMoves(Types::Coord coord)
 {
     std::vector<Types::Coord> moves;
     std::vector<Types::Coord> possibleMoves = {
@@ -197,7 +204,7 @@ std::vector<Types::Coord> PieceLogic::getWarEngineMoves(Types::Coord coord, char
     {
         if (move.x >= 0 && move.x <= Chessboard::rows &&
             move.y >= 0 && move.y < Chessboard::cols - 1 &&
-            chessboard.getPiece(move).color() != player)
+            chessboard.getPiece(move).color() != Player)
         {
             moves.push_back(move);
         }
@@ -206,7 +213,8 @@ std::vector<Types::Coord> PieceLogic::getWarEngineMoves(Types::Coord coord, char
     return moves;
 }
 
-std::vector<Types::Coord> PieceLogic::getAdminMoves(Types::Coord coord, char player)
+template <char Player>
+std::vector<Types::Coord> PieceLogic::getAdminMoves(Types::Coord coord)
 {
     std::vector<Types::Coord> moves;
 
@@ -215,7 +223,7 @@ std::vector<Types::Coord> PieceLogic::getAdminMoves(Types::Coord coord, char pla
         Types::Coord move = {coord.x + direction.x, coord.y + direction.y};
         if (move.x >= 0 && move.x <= Chessboard::rows &&
             move.y >= 0 && move.y < Chessboard::cols - 1 &&
-            chessboard.getPiece(move).color() != player)
+            chessboard.getPiece(move).color() != Player)
         {
             moves.push_back(move);
         }
@@ -224,7 +232,8 @@ std::vector<Types::Coord> PieceLogic::getAdminMoves(Types::Coord coord, char pla
     return moves;
 }
 
-std::vector<Types::Coord> PieceLogic::getMongolMoves(Types::Coord coord, char player)
+template <char Player>
+std::vector<Types::Coord> PieceLogic::getMongolMoves(Types::Coord coord)
 {
     std::vector<Types::Coord> moves;
 
@@ -242,7 +251,7 @@ std::vector<Types::Coord> PieceLogic::getMongolMoves(Types::Coord coord, char pl
     {
         if (move.x >= 0 && move.x <= Chessboard::rows &&
             move.y >= 0 && move.y < Chessboard::cols - 1 &&
-            chessboard.getPiece(move).color() != player)
+            chessboard.getPiece(move).color() != Player)
         {
             moves.push_back(move);
         }
@@ -251,7 +260,8 @@ std::vector<Types::Coord> PieceLogic::getMongolMoves(Types::Coord coord, char pl
     return moves;
 }
 
-std::vector<Types::Coord> PieceLogic::getCamelMoves(Types::Coord coord, char player)
+template <char Player>
+std::vector<Types::Coord> PieceLogic::getCamelMoves(Types::Coord coord)
 {
     std::vector<Types::Coord> moves;
 
@@ -269,7 +279,7 @@ std::vector<Types::Coord> PieceLogic::getCamelMoves(Types::Coord coord, char pla
     {
         if (move.x >= 0 && move.x <= Chessboard::rows &&
             move.y >= 0 && move.y < Chessboard::cols - 1 &&
-            chessboard.getPiece(move).color() != player)
+            chessboard.getPiece(move).color() != Player)
         {
             moves.push_back(move);
         }
@@ -278,11 +288,12 @@ std::vector<Types::Coord> PieceLogic::getCamelMoves(Types::Coord coord, char pla
     return moves;
 }
 
-std::vector<Types::Coord> PieceLogic::getGiraffeMoves(Types::Coord coord, char player)
+template <char Player>
+std::vector<Types::Coord> PieceLogic::getGiraffeMoves(Types::Coord coord)
 {
     std::vector<Types::Coord> moves;
     int directions[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
-    char enemy = (player == 'w') ? 'b' : 'w';
+    constexpr char enemy = (Player == 'w') ? 'b' : 'w';
 
     for (auto &dir : directions)
     {
@@ -374,19 +385,20 @@ std::vector<Types::Coord> PieceLogic::getGiraffeMoves(Types::Coord coord, char p
 }
 
 // alternative move logic (blitz)
-std::vector<Types::Coord> PieceLogic::getAltPawnMoves(Types::Coord coord, char player)
+template <char Player>
+std::vector<Types::Coord> PieceLogic::getAltPawnMoves(Types::Coord coord)
 {
     std::vector<Types::Coord> moves;
-    int direction = (player == 'w') ? -1 : 1;
-    char enemy = (player == 'w') ? 'b' : 'w';
+    constexpr int direction = (Player == 'w') ? -1 : 1;
+    constexpr char enemy = (Player == 'w') ? 'b' : 'w';
 
     // Check if it's the pawn's first move
-    bool isFirstMove = (player == 'w' && coord.y == 7) ||
-                       (player == 'b' && coord.y == 2);
+    bool isFirstMove = (Player == 'w' && coord.y == 7) ||
+                       (Player == 'b' && coord.y == 2);
 
     // Single move forward
     Types::Coord forwardMove = {coord.x, coord.y + direction};
-    if (forwardMove.y >= 0 && forwardMove.y < Chessboard::cols &&
+    if (forwardMove.y >= 0 && forwardMove.y < Chessboard::rows &&
         chessboard.getPiece(forwardMove) == "---")
     {
         moves.push_back(forwardMove);
@@ -395,7 +407,7 @@ std::vector<Types::Coord> PieceLogic::getAltPawnMoves(Types::Coord coord, char p
         if (isFirstMove)
         {
             Types::Coord doubleMove = {coord.x, coord.y + 2 * direction};
-            if (doubleMove.y >= 0 && doubleMove.y < Chessboard::cols &&
+            if (doubleMove.y >= 0 && doubleMove.y < Chessboard::rows &&
                 chessboard.getPiece(doubleMove) == "---")
             {
                 moves.push_back(doubleMove);
@@ -405,16 +417,16 @@ std::vector<Types::Coord> PieceLogic::getAltPawnMoves(Types::Coord coord, char p
 
     // Captures
     Types::Coord leftCapture = {coord.x - 1, coord.y + direction};
-    if (leftCapture.x >= 0 && leftCapture.x < Chessboard::rows &&
-        leftCapture.y >= 0 && leftCapture.y < Chessboard::cols &&
+    if (leftCapture.x >= 0 && leftCapture.x < Chessboard::cols &&
+        leftCapture.y >= 0 && leftCapture.y < Chessboard::rows &&
         chessboard.getPiece(leftCapture).color() == enemy)
     {
         moves.push_back(leftCapture);
     }
 
     Types::Coord rightCapture = {coord.x + 1, coord.y + direction};
-    if (rightCapture.x >= 0 && rightCapture.x < Chessboard::rows &&
-        rightCapture.y >= 0 && rightCapture.y < Chessboard::cols &&
+    if (rightCapture.x >= 0 && rightCapture.x < Chessboard::cols &&
+        rightCapture.y >= 0 && rightCapture.y < Chessboard::rows &&
         chessboard.getPiece(rightCapture).color() == enemy)
     {
         moves.push_back(rightCapture);
@@ -423,7 +435,8 @@ std::vector<Types::Coord> PieceLogic::getAltPawnMoves(Types::Coord coord, char p
     return moves;
 }
 
-std::vector<Types::Coord> PieceLogic::getAltWarEngineMoves(Types::Coord coord, char player)
+template <char Player>
+std::vector<Types::Coord> PieceLogic::getAltWarEngineMoves(Types::Coord coord)
 {
     std::vector<Types::Coord> moves;
 
@@ -444,7 +457,7 @@ std::vector<Types::Coord> PieceLogic::getAltWarEngineMoves(Types::Coord coord, c
     {
         if (move.x >= 0 && move.x <= Chessboard::rows &&
             move.y >= 0 && move.y < Chessboard::cols - 1 &&
-            chessboard.getPiece(move).color() != player)
+            chessboard.getPiece(move).color() != Player)
         {
             moves.push_back(move);
         }
@@ -453,7 +466,8 @@ std::vector<Types::Coord> PieceLogic::getAltWarEngineMoves(Types::Coord coord, c
     return moves;
 }
 
-std::vector<Types::Coord> PieceLogic::getAltElephantMoves(Types::Coord coord, char player)
+template <char Player>
+std::vector<Types::Coord> PieceLogic::getAltElephantMoves(Types::Coord coord)
 {
     std::vector<Types::Coord> moves;
 
@@ -474,7 +488,7 @@ std::vector<Types::Coord> PieceLogic::getAltElephantMoves(Types::Coord coord, ch
     {
         if (move.x >= 0 && move.x <= Chessboard::rows &&
             move.y >= 0 && move.y < Chessboard::cols - 1 &&
-            chessboard.getPiece(move).color() != player)
+            chessboard.getPiece(move).color() != Player)
         {
             moves.push_back(move);
         }
@@ -483,7 +497,8 @@ std::vector<Types::Coord> PieceLogic::getAltElephantMoves(Types::Coord coord, ch
     return moves;
 }
 
-std::vector<Types::Coord> PieceLogic::getAltVizierMoves(Types::Coord coord, char player)
+template <char Player>
+std::vector<Types::Coord> PieceLogic::getAltVizierMoves(Types::Coord coord)
 {
     std::vector<Types::Coord> moves;
 
@@ -504,7 +519,7 @@ std::vector<Types::Coord> PieceLogic::getAltVizierMoves(Types::Coord coord, char
     {
         if (move.x >= 0 && move.x <= Chessboard::rows &&
             move.y >= 0 && move.y < Chessboard::cols - 1 &&
-            chessboard.getPiece(move).color() != player)
+            chessboard.getPiece(move).color() != Player)
         {
             moves.push_back(move);
         }
@@ -513,7 +528,8 @@ std::vector<Types::Coord> PieceLogic::getAltVizierMoves(Types::Coord coord, char
     return moves;
 }
 
-std::vector<Types::Coord> PieceLogic::getAltAdminMoves(Types::Coord coord, char player)
+template <char Player>
+std::vector<Types::Coord> PieceLogic::getAltAdminMoves(Types::Coord coord)
 {
     std::vector<Types::Coord> moves;
 
@@ -533,7 +549,7 @@ std::vector<Types::Coord> PieceLogic::getAltAdminMoves(Types::Coord coord, char
     {
         if (move.x >= 0 && move.x <= Chessboard::rows &&
             move.y >= 0 && move.y < Chessboard::cols - 1 &&
-            chessboard.getPiece(move).color() != player)
+            chessboard.getPiece(move).color() != Player)
         {
             moves.push_back(move);
         }
@@ -541,3 +557,27 @@ std::vector<Types::Coord> PieceLogic::getAltAdminMoves(Types::Coord coord, char
 
     return moves;
 }
+
+// both sides are instantiated here so the generators can stay out of the
+// header
+#define INSTANTIATE_PIECE_LOGIC(Player)                                                        \
+    template std::vector<Types::Coord> PieceLogic::getPawnMoves<Player>(Types::Coord);         \
+    template std::vector<Types::Coord> PieceLogic::getRookMoves<Player>(Types::Coord);         \
+    template std::vector<Types::Coord> PieceLogic::getTaliaMoves<Player>(Types::Coord);        \
+    template std::vector<Types::Coord> PieceLogic::getElephantMoves<Player>(Types::Coord);     \
+    template std::vector<Types::Coord> PieceLogic::getVizierMoves<Player>(Types::Coord);       \
+    template std::vector<Types::Coord> PieceLogic::getKhanMoves<Player>(Types::Coord);         \
+    template std::vector<Types::Coord> PieceLogic::getWarEngineMoves<Player>(Types::Coord);    \
+    template std::vector<Types::Coord> PieceLogic::getAdminMoves<Player>(Types::Coord);        \
+    template std::vector<Types::Coord> PieceLogic::getMongolMoves<Player>(Types::Coord);       \
+    template std::vector<Types::Coord> PieceLogic::getCamelMoves<Player>(Types::Coord);        \
+    template std::vector<Types::Coord> PieceLogic::getGiraffeMoves<Player>(Types::Coord);      \
+    template std::vector<Types::Coord> PieceLogic::getAltPawnMoves<Player>(Types::Coord);      \
+    template std::vector<Types::Coord> PieceLogic::getAltWarEngineMoves<Player>(Types::Coord); \
+    template std::vector<Types::Coord> PieceLogic::getAltElephantMoves<Player>(Types::Coord);  \
+    template std::vector<Types::Coord> PieceLogic::getAltVizierMoves<Player>(Types::Coord);    \
+    template std::vector<Types::Coord> PieceLogic::getAltAdminMoves<Player>(Types::Coord);
+
+INSTANTIATE_PIECE_LOGIC('w')
+INSTANTIATE_PIECE_LOGIC('b')
+#undef INSTANTIATE_PIECE_LOGIC
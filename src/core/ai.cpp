@@ -5,27 +5,21 @@
 #include <algorithm>
 #include <limits>
 #include <unordered_map>
-#include <iostream>
 #include <chrono>
 #include <string>
 #include <cmath>
+#include <sstream>
+#include <array>
+#include <cassert>
 #include "types.h"
 #include "globals.h"
 #include "utility.h"
 #include "ai.h"
-
-const std::unordered_map<char, float> AI::pieceValues = {
-    {'K', 3.5f},
-    {'p', 1.0f},
-    {'M', 3.0f},
-    {'C', 2.0f},
-    {'G', 4.0f},
-    {'R', 5.0f},
-    {'T', 2.5f},
-    {'E', 1.5f},
-    {'W', 2.0f},
-    {'V', 1.5f},
-    {'A', 1.5f}};
+#include "zobrist.h"
+#include "evaluation.h"
+#include "log.h"
+#include "nnue.h"
+#include "trace.h"
 
 // Helper function to round to 2 decimal places
 static float roundToTwoDecimals(float value)
@@ -40,163 +34,646 @@ static bool roundedFloatsEqual(float a, float b)
     return std::abs(a - b) < epsilon;
 }
 
+// the only place the rule set and side to move are looked at at runtime,
+// everything below is instantiated for each combination
 Types::Turn AI::minMax(char player,
                        int turn,
                        bool alt,
                        int depth,
                        float alpha,
                        float beta)
+{
+    TRACE_ZONE("AI::minMax");
+    if (alt)
+        return (player == 'w') ? iterativeDeepening<true, 'w'>(turn, depth, alpha, beta)
+                               : iterativeDeepening<true, 'b'>(turn, depth, alpha, beta);
+    return (player == 'w') ? iterativeDeepening<false, 'w'>(turn, depth, alpha, beta)
+                           : iterativeDeepening<false, 'b'>(turn, depth, alpha, beta);
+}
+
+template <bool Alt, char Player>
+Types::Turn AI::iterativeDeepening(int turn, int depth, float alpha, float beta)
 {
     auto start = std::chrono::high_resolution_clock::now();
+    searchStart = start;
+    aborted = false;
+    stats = Types::SearchStats();
+    if (options.deterministic)
+    {
+        transpositionTable.clear();
+        pawnHash.clear();
+        evalCache.clear();
+    }
+    else
+        transpositionTable.newSearch();
+    rootTurn = turn;
+    previousPv.clear();
+    principalVariation.clear();
 
-    std::vector<Types::Turn> allMoves = generateAllLegalMoves(player, turn, alt);
+    std::vector<Types::Turn> allMoves = generateAllLegalMoves<Alt, Player>(turn);
     if (allMoves.empty())
     {
         throw std::runtime_error("No legal moves available for AI player");
     }
 
-    // Sort moves to evaluate captures first
-    std::sort(allMoves.begin(), allMoves.end(),
-              [](const Types::Turn &a, const Types::Turn &b)
-              { return a.pieceCaptured != "---" && b.pieceCaptured == "---"; });
+    // positions in the book are played straight away without a search
+    Types::Turn bookMove;
+    if (options.useOpeningBook && pickBookMove(Player, Alt, allMoves, bookMove))
+    {
+        chessboard.setCell(bookMove.finalSquare, bookMove.pieceMoved);
+        chessboard.setCell(bookMove.initialSquare, "---");
+        bookMove.score = evaluateBoard();
+        chessboard.setCell(bookMove.initialSquare, bookMove.pieceMoved);
+        chessboard.setCell(bookMove.finalSquare, bookMove.pieceCaptured);
+
+        principalVariation = {bookMove};
+        stats.bookMove = true;
+        LOG_INFO("AI move from opening book");
+        if (options.searchStatsJson)
+            Log::record(searchJson(stats));
+        return bookMove;
+    }
+
+    // Winning and even captures first, losing captures last
+    orderMoves<Alt>(allMoves);
 
     std::vector<Types::Turn> bestMoves;
-    float bestRoundedValue = (player == 'w') ? -std::numeric_limits<float>::infinity()
-                                            : std::numeric_limits<float>::infinity();
-    float bestValue = (player == 'w') ? -std::numeric_limits<float>::infinity()
-                                      : std::numeric_limits<float>::infinity();
+    std::vector<std::vector<Types::Turn>> bestLines;
+    float bestValue = 0.0f;
+
+    // iterative deepening, each iteration seeds the move order and the
+    // aspiration window of the next one
+    for (int iteration = 1; iteration <= depth; ++iteration)
+    {
+        TRACE_ZONE("AI::iteration");
+        auto iterationStart = std::chrono::high_resolution_clock::now();
+        long long nodesBefore = stats.nodes + stats.quiescenceNodes;
+        float window = ASPIRATION_WINDOW;
+        float lower = alpha;
+        float upper = beta;
+        if (iteration > 1 && std::abs(bestValue) < MATE_SCORE)
+        {
+            lower = std::max(alpha, bestValue - window);
+            upper = std::min(beta, bestValue + window);
+        }
+
+        while (true)
+        {
+            std::vector<Types::Turn> candidates;
+            std::vector<std::vector<Types::Turn>> candidateLines;
+            float value = searchRoot<Alt, Player>(allMoves, turn, iteration,
+                                                  lower, upper, candidates, candidateLines);
+            if (aborted)
+                break;
+
+            // widen the side of the window the score fell out of
+            window *= 2.0f;
+            if (value <= lower && lower > alpha)
+            {
+                lower = (window > MAX_ASPIRATION_WINDOW) ? alpha
+                                                         : std::max(alpha, value - window);
+                continue;
+            }
+            if (value >= upper && upper < beta)
+            {
+                upper = (window > MAX_ASPIRATION_WINDOW) ? beta
+                                                         : std::min(beta, value + window);
+                continue;
+            }
+
+            bestValue = value;
+            bestMoves = candidates;
+            bestLines = candidateLines;
+            break;
+        }
+
+        // a cut off iteration is thrown away, the last finished one stands
+        if (aborted)
+        {
+            stats.stopped = true;
+            break;
+        }
+
+        // search the best move first next iteration and follow its line
+        if (!bestLines.empty())
+        {
+            previousPv = bestLines.front();
+            auto best = std::find_if(allMoves.begin(), allMoves.end(),
+                                     [&](const Types::Turn &move)
+                                     { return sameMove(move, previousPv.front()); });
+            std::rotate(allMoves.begin(), best, best + 1);
+        }
+
+        Types::IterationStats iterationStats;
+        iterationStats.depth = iteration;
+        iterationStats.score = bestValue;
+        iterationStats.nodes = stats.nodes + stats.quiescenceNodes - nodesBefore;
+        iterationStats.seconds = std::chrono::duration<double>(
+                                     std::chrono::high_resolution_clock::now() - iterationStart)
+                                     .count();
+        stats.iterations.push_back(iterationStats);
+        stats.depth = iteration;
+        if (options.searchStatsJson)
+            Log::record(iterationJson(iterationStats));
+        if (iterationCallback && !bestLines.empty())
+            iterationCallback(iterationStats, bestLines.front());
+
+        if (options.nodeLimit > 0 &&
+            stats.nodes + stats.quiescenceNodes >= options.nodeLimit)
+            break;
+    }
+
+    // Randomly select from tied moves, deterministic mode takes the first
+    // in move order
+    if (bestMoves.empty())
+    {
+        // Fallback: should never happen, but use first move if it does
+        bestMoves.push_back(allMoves[0]);
+        bestLines.push_back({allMoves[0]});
+    }
+    size_t choice = 0;
+    if (!options.deterministic)
+    {
+        std::uniform_int_distribution<size_t> dist(0, bestMoves.size() - 1);
+        choice = dist(rng);
+    }
+    Types::Turn bestMove = bestMoves[choice];
+    principalVariation = bestLines[choice];
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    LOG_INFO("AI move calculation time: " << elapsed.count() << " seconds"
+             << " (" << stats.nodes << " nodes, "
+             << stats.quiescenceNodes << " quiescence nodes)");
+
+    stats.seconds = elapsed.count();
+    long long totalNodes = stats.nodes + stats.quiescenceNodes;
+    if (stats.seconds > 0.0)
+        stats.nodesPerSecond = static_cast<double>(totalNodes) / stats.seconds;
+    if (stats.iterations.size() >= 2)
+    {
+        const auto &last = stats.iterations.back();
+        const auto &previous = stats.iterations[stats.iterations.size() - 2];
+        if (previous.nodes > 0)
+            stats.effectiveBranchingFactor =
+                static_cast<double>(last.nodes) / static_cast<double>(previous.nodes);
+    }
+    if (stats.betaCutoffs > 0)
+        stats.firstMoveCutoffRate = static_cast<double>(stats.firstMoveCutoffs) /
+                                    static_cast<double>(stats.betaCutoffs);
+    if (options.searchStatsJson)
+        Log::record(searchJson(stats));
+
+    bestMove.score = bestValue;
+    return bestMove;
+}
+
+// searches every root move inside (alpha, beta) and collects the moves that
+// tie for the best rounded score together with their principal variations
+template <bool Alt, char Player>
+float AI::searchRoot(const std::vector<Types::Turn> &rootMoves,
+                     int turn,
+                     int depth,
+                     float alpha,
+                     float beta,
+                     std::vector<Types::Turn> &bestMoves,
+                     std::vector<std::vector<Types::Turn>> &bestLines)
+{
+    constexpr bool maximizing = (Player == 'w');
+    constexpr char opponent = maximizing ? 'b' : 'w';
+    float bestRoundedValue = maximizing ? -std::numeric_limits<float>::infinity()
+                                        : std::numeric_limits<float>::infinity();
+    float bestValue = bestRoundedValue;
 
     GameLogic gameLogic;
-    for (const auto &move : allMoves)
+    for (size_t i = 0; i < rootMoves.size(); ++i)
     {
+        const auto &move = rootMoves[i];
+
         // Make move
-        std::string originalPiece = chessboard.getPiece(move.finalSquare).toString();
         chessboard.setCell(move.finalSquare, move.pieceMoved);
         chessboard.setCell(move.initialSquare, "---");
 
-        // Evaluate position
+        // principal variation search, the first move gets the full window
+        // and the rest are proven worse with a zero window. The zero window
+        // sits just past the best score so moves that tie after rounding are
+        // re-searched and get an exact score to be picked from
         float value;
-        if (depth <= 1)
+        float bound = maximizing ? alpha - TIE_MARGIN : beta + TIE_MARGIN;
+        if (i == 0 || !std::isfinite(bound))
+        {
+            value = minMaxHelper<Alt, opponent>(gameLogic, turn + 1,
+                                 depth - 1, alpha, beta);
+        }
+        else if (maximizing)
         {
-            value = evaluateBoard();
+            value = minMaxHelper<Alt, opponent>(gameLogic, turn + 1,
+                                 depth - 1, bound, bound + NULL_WINDOW);
+            if (value > bound)
+                value = minMaxHelper<Alt, opponent>(gameLogic, turn + 1,
+                                     depth - 1, bound, beta);
         }
         else
         {
-            value = minMaxHelper(gameLogic,
-                                 (player == 'w' ? 'b' : 'w'),
-                                 turn + 1,
-                                 alt,
-                                 depth - 1,
-                                 alpha,
-                                 beta);
+            value = minMaxHelper<Alt, opponent>(gameLogic, turn + 1,
+                                 depth - 1, bound - NULL_WINDOW, bound);
+            if (value < bound)
+                value = minMaxHelper<Alt, opponent>(gameLogic, turn + 1,
+                                     depth - 1, alpha, bound);
         }
 
         // Undo move
         chessboard.setCell(move.initialSquare, move.pieceMoved);
-        chessboard.setCell(move.finalSquare, originalPiece);
+        chessboard.setCell(move.finalSquare, move.pieceCaptured);
+        if (aborted)
+            return bestValue;
+
+        // root move followed by the line collected one ply down
+        std::vector<Types::Turn> line = {move};
+        line.insert(line.end(),
+                    pvTable[1].begin() + 1,
+                    pvTable[1].begin() + pvLength[1]);
 
         // Round value to 2 decimal places for comparison
         float roundedValue = roundToTwoDecimals(value);
 
         // Update best moves based on rounded value
-        if (player == 'w')
+        bool better = maximizing ? roundedValue > bestRoundedValue
+                                 : roundedValue < bestRoundedValue;
+        if (better)
         {
-            if (roundedValue > bestRoundedValue)
-            {
-                bestRoundedValue = roundedValue;
-                bestValue = value;
-                bestMoves.clear();
-                bestMoves.push_back(move);
-            }
-            else if (roundedFloatsEqual(roundedValue, bestRoundedValue))
-            {
-                bestMoves.push_back(move);
-            }
-            alpha = std::max(alpha, value);
+            bestRoundedValue = roundedValue;
+            bestValue = value;
+            bestMoves.clear();
+            bestLines.clear();
+            bestMoves.push_back(move);
+            bestLines.push_back(line);
         }
-        else
+        else if (roundedFloatsEqual(roundedValue, bestRoundedValue))
         {
-            if (roundedValue < bestRoundedValue)
-            {
-                bestRoundedValue = roundedValue;
-                bestValue = value;
-                bestMoves.clear();
-                bestMoves.push_back(move);
-            }
-            else if (roundedFloatsEqual(roundedValue, bestRoundedValue))
-            {
-                bestMoves.push_back(move);
-            }
-            beta = std::min(beta, value);
+            bestMoves.push_back(move);
+            bestLines.push_back(line);
         }
 
+        if (maximizing)
+            alpha = std::max(alpha, value);
+        else
+            beta = std::min(beta, value);
+
         if (beta <= alpha)
         {
             break;
         }
     }
 
-    // Randomly select from tied moves
-    if (bestMoves.empty())
+    return bestValue;
+}
+
+bool AI::sameMove(const Types::Turn &a, const Types::Turn &b)
+{
+    return a.initialSquare == b.initialSquare && a.finalSquare == b.finalSquare;
+}
+
+std::string AI::iterationJson(const Types::IterationStats &iteration)
+{
+    std::ostringstream json;
+    json << "{\"type\":\"iteration\""
+         << ",\"depth\":" << iteration.depth
+         << ",\"score\":" << iteration.score
+         << ",\"nodes\":" << iteration.nodes
+         << ",\"seconds\":" << iteration.seconds << "}";
+    return json.str();
+}
+
+// one line per search, nested iterations included, so a log can be
+// read back with any JSON lines reader
+std::string AI::searchJson(const Types::SearchStats &searchStats)
+{
+    std::ostringstream json;
+    json << "{\"type\":\"search\""
+         << ",\"depth\":" << searchStats.depth
+         << ",\"seldepth\":" << searchStats.selectiveDepth
+         << ",\"nodes\":" << searchStats.nodes
+         << ",\"qnodes\":" << searchStats.quiescenceNodes
+         << ",\"seconds\":" << searchStats.seconds
+         << ",\"nps\":" << static_cast<long long>(searchStats.nodesPerSecond)
+         << ",\"ebf\":" << searchStats.effectiveBranchingFactor
+         << ",\"tt_probes\":" << searchStats.ttProbes
+         << ",\"tt_hits\":" << searchStats.ttHits
+         << ",\"tt_cutoffs\":" << searchStats.ttCutoffs
+         << ",\"tb_hits\":" << searchStats.tablebaseHits
+         << ",\"pawn_hash_probes\":" << searchStats.pawnHashProbes
+         << ",\"pawn_hash_hits\":" << searchStats.pawnHashHits
+         << ",\"eval_cache_probes\":" << searchStats.evalCacheProbes
+         << ",\"eval_cache_hits\":" << searchStats.evalCacheHits
+         << ",\"beta_cutoffs\":" << searchStats.betaCutoffs
+         << ",\"first_move_cutoff_rate\":" << searchStats.firstMoveCutoffRate
+         << ",\"book\":" << (searchStats.bookMove ? "true" : "false")
+         << ",\"iterations\":[";
+    for (size_t i = 0; i < searchStats.iterations.size(); ++i)
     {
-        // Fallback: should never happen, but use first move if it does
-        bestMoves.push_back(allMoves[0]);
+        if (i > 0)
+            json << ",";
+        json << iterationJson(searchStats.iterations[i]);
     }
-    std::uniform_int_distribution<size_t> dist(0, bestMoves.size() - 1);
-    Types::Turn bestMove = bestMoves[dist(rng)];
+    json << "]}";
+    return json.str();
+}
 
-    auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> elapsed = end - start;
-    std::cout << "AI move calculation time: " << elapsed.count() << " seconds"
-              << std::endl;
+// weighted pick among the book moves of the position that are legal here,
+// deterministic mode always takes the heaviest
+bool AI::pickBookMove(char player,
+                      bool alt,
+                      const std::vector<Types::Turn> &legalMoves,
+                      Types::Turn &move)
+{
+    if (!openingBook.isOpen())
+        return false;
 
-    bestMove.score = bestValue;
-    return bestMove;
+    uint64_t key = Zobrist::hash(chessboard.getBoardState(), player, alt);
+    std::vector<Types::Turn> candidates;
+    std::vector<double> weights;
+    for (const auto &entry : openingBook.probe(key))
+    {
+        if (entry.weight == 0)
+            continue;
+
+        Types::Coord from = {entry.fromX, entry.fromY};
+        Types::Coord to = {entry.toX, entry.toY};
+        auto legal = std::find_if(legalMoves.begin(), legalMoves.end(),
+                                  [&](const Types::Turn &turn)
+                                  { return turn.initialSquare == from && turn.finalSquare == to; });
+        if (legal == legalMoves.end())
+            continue;
+
+        candidates.push_back(*legal);
+        weights.push_back(entry.weight);
+    }
+
+    if (candidates.empty())
+        return false;
+
+    size_t choice = 0;
+    if (options.deterministic)
+    {
+        choice = static_cast<size_t>(std::max_element(weights.begin(), weights.end()) -
+                                     weights.begin());
+    }
+    else
+    {
+        std::discrete_distribution<size_t> dist(weights.begin(), weights.end());
+        choice = dist(rng);
+    }
+    move = candidates[choice];
+    return true;
+}
+
+void AI::setOptions(const Types::SearchOptions &searchOptions)
+{
+    if (searchOptions.hashSizeMb != options.hashSizeMb)
+        transpositionTable.resize(static_cast<size_t>(std::max(1, searchOptions.hashSizeMb)));
+    if (searchOptions.evalCacheSizeMb != options.evalCacheSizeMb)
+        evalCache.resize(static_cast<size_t>(std::max(0, searchOptions.evalCacheSizeMb)));
+    // cached scores came from the other evaluator
+    if (searchOptions.useNnue != options.useNnue)
+        evalCache.clear();
+    if (searchOptions.seed != 0)
+        rng.seed(searchOptions.seed);
+    options = searchOptions;
+
+    // precompute the late move reductions so the search only does a lookup
+    for (int depth = 0; depth < REDUCTION_TABLE_SIZE; ++depth)
+    {
+        for (int move = 0; move < REDUCTION_TABLE_SIZE; ++move)
+        {
+            if (depth == 0 || move == 0)
+            {
+                reductionTable[depth][move] = 0;
+                continue;
+            }
+            float reduction = options.lateMoveBase +
+                              std::log(static_cast<float>(depth)) *
+                                  std::log(static_cast<float>(move)) /
+                                  options.lateMoveDivisor;
+            reductionTable[depth][move] = std::max(0, static_cast<int>(reduction));
+        }
+    }
 }
 
+template <bool Alt, char Player>
 float AI::minMaxHelper(GameLogic gameLogic,
-                       char player,
                        int turn,
-                       bool alt,
                        int depth,
                        float alpha,
-                       float beta)
+                       float beta,
+                       bool nullMoveAllowed)
 {
-    if (depth == 0)
-        return evaluateBoard();
+    const int ply = turn - rootTurn;
+    if (ply < MAX_PLY)
+        pvLength[ply] = ply;
+
+    if (depth <= 0)
+        return quiescenceSearch<Alt, Player>(alpha, beta,
+                                             stats.quiescenceNodes + MAX_QUIESCENCE_NODES,
+                                             QUIESCENCE_DEPTH, ply);
+
+    ++stats.nodes;
+    stats.selectiveDepth = std::max(stats.selectiveDepth, ply);
+    if (searchStopped())
+        return 0.0f;
+
+    constexpr bool maximizing = (Player == 'w');
+    constexpr char opponent = maximizing ? 'b' : 'w';
+    const float alphaOriginal = alpha;
+    const float betaOriginal = beta;
+
+    // a deep enough stored result ends the node, otherwise its best move
+    // is tried first
+    uint64_t key = chessboard.getPieceKey() ^ Zobrist::stateKey(Player, Alt);
+    assert(key == Zobrist::hash(chessboard.getBoardState(), Player, Alt));
+    TranspositionTable::Entry entry;
+    bool ttMove = false;
+    ++stats.ttProbes;
+    if (transpositionTable.probe(key, entry))
+    {
+        ++stats.ttHits;
+        if (entry.depth >= depth &&
+            (entry.bound == TranspositionTable::Bound::Exact ||
+             (entry.bound == TranspositionTable::Bound::Lower && entry.score >= beta) ||
+             (entry.bound == TranspositionTable::Bound::Upper && entry.score <= alpha)))
+        {
+            ++stats.ttCutoffs;
+            return entry.score;
+        }
+        ttMove = entry.hasMove();
+    }
+
+    // small enough endings are looked up instead of searched
+    Tablebase::ProbeResult tablebaseResult;
+    if (options.useTablebases && tablebase.tableCount() > 0 &&
+        tablebase.probe(chessboard.getBoardState(), Player, Alt,
+                        tablebaseResult, options.tablebasePieces))
+    {
+        ++stats.tablebaseHits;
+        float score = 0.0f;
+        if (tablebaseResult.outcome == Tablebase::Outcome::Win)
+            score = TABLEBASE_WIN - static_cast<float>(tablebaseResult.distance);
+        else if (tablebaseResult.outcome == Tablebase::Outcome::Loss)
+            score = -(TABLEBASE_WIN - static_cast<float>(tablebaseResult.distance));
+        return maximizing ? score : -score;
+    }
+
+    bool inCheck = gameLogic.isKingInCheck<Alt, Player>(chessboard.getBoardState());
+
+    // null move pruning, hand the opponent a free move and search shallower,
+    // if we still beat the bound the real moves will too. Skipped when only
+    // the Khan and pawns are left since zugzwang is likely there
+    if (options.nullMovePruning && nullMoveAllowed && !inCheck &&
+        depth > options.nullMoveReduction &&
+        (maximizing ? beta < MATE_SCORE : alpha > -MATE_SCORE) &&
+        hasNonPawnMaterial(Player))
+    {
+        int nullDepth = depth - 1 - options.nullMoveReduction;
+        if (maximizing)
+        {
+            float value = minMaxHelper<Alt, opponent>(gameLogic, turn + 1,
+                                       nullDepth, beta - NULL_WINDOW, beta,
+                                       false);
+            if (value >= beta)
+                return value;
+        }
+        else
+        {
+            float value = minMaxHelper<Alt, opponent>(gameLogic, turn + 1,
+                                       nullDepth, alpha, alpha + NULL_WINDOW,
+                                       false);
+            if (value <= alpha)
+                return value;
+        }
+    }
 
-    float bestValue = (player == 'w') ? -std::numeric_limits<float>::infinity()
-                                      : std::numeric_limits<float>::infinity();
+    float bestValue = maximizing ? -std::numeric_limits<float>::infinity()
+                                 : std::numeric_limits<float>::infinity();
+
+    std::vector<Types::Turn> allMoves = generateAllLegalMoves<Alt, Player>(turn);
+
+    // no legal moves, checkmate or stalemate (stalemate is scored as a draw)
+    if (allMoves.empty())
+    {
+        if (inCheck)
+        {
+            return maximizing ? -MATE_SCORE : MATE_SCORE;
+        }
+        return 0.0f;
+    }
+
+    // a Khan next to its fortress can step in for a draw, which counts as
+    // one more move. Mate comes first, it ends the game before that
+    if (gameLogic.canDraw(Player))
+    {
+        bestValue = 0.0f;
+        if (maximizing)
+            alpha = std::max(alpha, bestValue);
+        else
+            beta = std::min(beta, bestValue);
+        if (beta <= alpha)
+            return bestValue;
+    }
 
-    std::vector<Types::Turn> allMoves = generateAllLegalMoves(player,
-                                                              turn, alt);
+    orderMoves<Alt>(allMoves);
 
-    std::sort(allMoves.begin(), allMoves.end(),
-              [](const Types::Turn &a, const Types::Turn &b)
-              { return a.pieceCaptured != "---" && b.pieceCaptured == "---"; });
+    if (ttMove)
+    {
+        Types::Coord from = {entry.fromX, entry.fromY};
+        Types::Coord to = {entry.toX, entry.toY};
+        auto hashMove = std::find_if(allMoves.begin(), allMoves.end(),
+                                     [&](const Types::Turn &move)
+                                     { return move.initialSquare == from && move.finalSquare == to; });
+        if (hashMove != allMoves.end())
+            std::rotate(allMoves.begin(), hashMove, hashMove + 1);
+    }
 
-    const int maxMovesToConsider = std::min(static_cast<int>(
-                                                allMoves.size()),
-                                            5);
+    // the move the previous iteration found best here goes first
+    if (ply < static_cast<int>(previousPv.size()))
+    {
+        auto pvMove = std::find_if(allMoves.begin(), allMoves.end(),
+                                   [&](const Types::Turn &move)
+                                   { return sameMove(move, previousPv[ply]); });
+        if (pvMove != allMoves.end())
+            std::rotate(allMoves.begin(), pvMove, pvMove + 1);
+    }
 
-    for (int i = 0; i < maxMovesToConsider; ++i)
+    const Types::Turn *bestMove = nullptr;
+    for (size_t i = 0; i < allMoves.size(); ++i)
     {
         const auto &moveInfo = allMoves[i];
         chessboard.setCell(moveInfo.finalSquare, moveInfo.pieceMoved);
         chessboard.setCell(moveInfo.initialSquare, "---");
 
-        float value = minMaxHelper(gameLogic,
-                                   (player == 'w' ? 'b' : 'w'),
-                                   turn + 1,
-                                   alt,
-                                   depth - 1,
-                                   alpha,
-                                   beta);
+        // late move reductions, quiet moves ordered late are searched
+        // shallower with a zero window and only re-searched at full depth
+        // when they turn out to beat the bound
+        int reduction = 0;
+        if (options.lateMoveReductions && !inCheck && depth >= 3 &&
+            static_cast<int>(i) >= options.lateMoveFullDepthMoves &&
+            moveInfo.pieceCaptured == "---" &&
+            std::isfinite(maximizing ? alpha : beta))
+        {
+            reduction = reductionTable[std::min(depth, REDUCTION_TABLE_SIZE - 1)]
+                                      [std::min(static_cast<int>(i), REDUCTION_TABLE_SIZE - 1)];
+            reduction = std::min(reduction, depth - 2);
+        }
+
+        // principal variation search, only the first move gets the full
+        // window, the others are searched with a zero window (reduced if
+        // late) and re-searched when they beat the bound after all
+        float value;
+        if (i == 0 || !std::isfinite(maximizing ? alpha : beta))
+        {
+            value = minMaxHelper<Alt, opponent>(gameLogic, turn + 1,
+                                 depth - 1, alpha, beta);
+        }
+        else
+        {
+            auto zeroWindow = [&](int searchDepth)
+            {
+                return maximizing
+                           ? minMaxHelper<Alt, opponent>(gameLogic, turn + 1,
+                                          searchDepth, alpha, alpha + NULL_WINDOW)
+                           : minMaxHelper<Alt, opponent>(gameLogic, turn + 1,
+                                          searchDepth, beta - NULL_WINDOW, beta);
+            };
+            auto improves = [&](float score)
+            { return maximizing ? score > alpha : score < beta; };
+
+            value = zeroWindow(depth - 1 - reduction);
+            if (reduction > 0 && improves(value))
+                value = zeroWindow(depth - 1);
+            if (improves(value) && beta - alpha > 2.0f * NULL_WINDOW)
+                value = minMaxHelper<Alt, opponent>(gameLogic, turn + 1,
+                                     depth - 1, alpha, beta);
+        }
 
         chessboard.setCell(moveInfo.initialSquare, moveInfo.pieceMoved);
         chessboard.setCell(moveInfo.finalSquare, moveInfo.pieceCaptured);
+        // the scores of a cut off search are meaningless, keep them out of
+        // the line and the table
+        if (aborted)
+            return 0.0f;
+
+        // new best line through this node, this move plus the child's line
+        if ((maximizing ? value > alpha : value < beta) && ply + 1 < MAX_PLY)
+        {
+            pvTable[ply][ply] = moveInfo;
+            for (int next = ply + 1; next < pvLength[ply + 1]; ++next)
+                pvTable[ply][next] = pvTable[ply + 1][next];
+            pvLength[ply] = std::max(ply + 1, pvLength[ply + 1]);
+        }
+
+        if (maximizing ? value > bestValue : value < bestValue)
+            bestMove = &moveInfo;
 
-        if (player == 'w')
+        if (maximizing)
         {
             bestValue = std::max(bestValue, value);
             alpha = std::max(alpha, bestValue);
@@ -208,15 +685,84 @@ float AI::minMaxHelper(GameLogic gameLogic,
         }
 
         if (beta <= alpha)
+        {
+            ++stats.betaCutoffs;
+            if (i == 0)
+                ++stats.firstMoveCutoffs;
             break;
+        }
     }
 
+    // bounds are relative to the window the node was entered with
+    TranspositionTable::Bound bound = TranspositionTable::Bound::Exact;
+    if (bestValue <= alphaOriginal)
+        bound = TranspositionTable::Bound::Upper;
+    else if (bestValue >= betaOriginal)
+        bound = TranspositionTable::Bound::Lower;
+    transpositionTable.store(key, depth, bestValue, bound, bestMove);
+
     return bestValue;
 }
 
+// true once the running search has to give up. The stop request, the
+// node budget and the clock are only looked at every STOP_CHECK_INTERVAL
+// nodes, and the limits leave the first iteration alone so there is
+// always a move to play
+bool AI::searchStopped()
+{
+    if (aborted)
+        return true;
+    long long nodes = stats.nodes + stats.quiescenceNodes;
+    if ((nodes & (STOP_CHECK_INTERVAL - 1)) != 0)
+        return false;
+
+    if (stopRequested.load(std::memory_order_relaxed))
+        aborted = true;
+    else if (options.nodeLimit > 0 && stats.depth > 0 && nodes >= options.nodeLimit)
+        aborted = true;
+    else if (options.timeLimitMs > 0 && stats.depth > 0)
+    {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - searchStart);
+        aborted = elapsed.count() >= options.timeLimitMs;
+    }
+    return aborted;
+}
+
+// true when the side has something other than Khans and pawns, used to
+// keep null move pruning out of likely zugzwang positions
+bool AI::hasNonPawnMaterial(char player)
+{
+    const Types::Board &board = chessboard.getBoardState();
+    for (int row = 0; row < Chessboard::rows; ++row)
+    {
+        for (int col = 0; col < Chessboard::cols; ++col)
+        {
+            const Types::Piece &piece = board.board[row][col];
+            if (piece.color() == player &&
+                piece.piece() != 'p' &&
+                piece.piece() != 'K')
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 std::vector<Types::Turn> AI::generateAllLegalMoves(char player,
                                                    int turn,
                                                    bool alt)
+{
+    if (alt)
+        return (player == 'w') ? generateAllLegalMoves<true, 'w'>(turn)
+                               : generateAllLegalMoves<true, 'b'>(turn);
+    return (player == 'w') ? generateAllLegalMoves<false, 'w'>(turn)
+                           : generateAllLegalMoves<false, 'b'>(turn);
+}
+
+template <bool Alt, char Player>
+std::vector<Types::Turn> AI::generateAllLegalMoves(int turn)
 {
     GameLogic gameLogic;
     std::vector<Types::Turn> allMoves;
@@ -229,22 +775,18 @@ std::vector<Types::Turn> AI::generateAllLegalMoves(char player,
             Types::Coord currentSquare = {col, row};
             std::string piece = chessboard.getPiece(currentSquare).toString();
 
-            if (piece[0] == player)
+            if (piece[0] == Player)
             {
-                auto possibleMoves = gameLogic.getMoves(currentSquare,
-                                                        piece,
-                                                        player,
-                                                        alt);
-                auto legalMoves = gameLogic.filterLegalMoves(possibleMoves,
-                                                             currentSquare,
-                                                             piece,
-                                                             player,
-                                                             alt);
+                auto possibleMoves = gameLogic.getMoves<Alt, Player>(currentSquare,
+                                                                     piece);
+                auto legalMoves = gameLogic.filterLegalMoves<Alt, Player>(possibleMoves,
+                                                                          currentSquare,
+                                                                          piece);
 
                 for (const auto &move : legalMoves)
                 {
                     allMoves.emplace_back(Types::Turn{turn,
-                                                      player,
+                                                      Player,
                                                       currentSquare,
                                                       move,
                                                       piece,
@@ -258,39 +800,71 @@ std::vector<Types::Turn> AI::generateAllLegalMoves(char player,
     return allMoves;
 }
 
+// material and square terms come from the running total on the board,
+// only the terms that depend on other pieces are computed here
 float AI::evaluateBoard()
 {
-    float score = 0;
-    for (int row = 0; row < Chessboard::rows; ++row)
+    assert(chessboard.getStaticTerms() ==
+           Evaluation::staticTerms(chessboard.getBoardState()));
+
+    // the evaluation ignores the side to move and the rule set, so the
+    // pieces alone key the cache
+    const uint64_t key = chessboard.getPieceKey();
+    const bool cached = options.evalCacheSizeMb > 0;
+    float score = 0.0f;
+    if (cached)
     {
-        for (int col = 0; col < Chessboard::cols; ++col)
+        ++stats.evalCacheProbes;
+        if (evalCache.probe(key, score))
         {
-            std::string piece = chessboard.getPiece({col, row}).toString();
-            if (piece != "---")
-            {
-                float pieceValue = pieceValues.at(piece[1]);
-                score += (piece[0] == 'w') ? pieceValue : -pieceValue;
+            ++stats.evalCacheHits;
+            return score;
+        }
+    }
 
-                // Add positional evaluation
-                score += evaluatePosition(piece, col, row);
+    if (options.useNnue && Nnue::isLoaded())
+    {
+        score = evaluateNnue();
+    }
+    else
+    {
+        score = static_cast<float>(chessboard.getStaticScore()) / 100.0f +
+                evaluatePawns();
+        for (int row = 0; row < Chessboard::rows; ++row)
+        {
+            for (int col = 0; col < Chessboard::cols; ++col)
+            {
+                std::string piece = chessboard.getPiece({col, row}).toString();
+                if (piece != "---")
+                {
+                    score += evaluatePosition(piece, col, row);
+                }
             }
         }
     }
+
+    if (cached)
+        evalCache.store(key, score);
     return score;
 }
 
+float AI::evaluateNnue()
+{
+#ifndef NDEBUG
+    // the accumulator setCell keeps must match a full refresh
+    Nnue::Accumulator fresh;
+    Nnue::refresh(chessboard.getBoardState(), fresh);
+    assert(fresh == chessboard.getAccumulator());
+#endif
+    return Nnue::evaluate(chessboard.getAccumulator());
+}
+
 float AI::evaluatePosition(const std::string &piece, int col, int row)
 {
     float positionScore = 0;
     char pieceType = piece[1];
     bool isWhite = (piece[0] == 'w');
 
-    // Evaluate pawn structure
-    if (pieceType == 'p')
-    {
-        positionScore += evaluatePawnStructure(col, row, isWhite);
-    }
-
     // Evaluate piece mobility
     positionScore += evaluatePieceMobility(piece, col, row);
 
@@ -300,25 +874,57 @@ float AI::evaluatePosition(const std::string &piece, int col, int row)
         positionScore += evaluateKingSafety(col, row, isWhite);
     }
 
-    // Evaluate control of the center
-    positionScore += evaluateCenterControl(col, row);
-
     return isWhite ? positionScore : -positionScore;
 }
 
+// white-relative pawn structure of the whole board, looked up by the
+// pawn-only key before any pawn is looked at
+float AI::evaluatePawns()
+{
+    const uint64_t key = chessboard.getPawnKey();
+    float score = 0.0f;
+    ++stats.pawnHashProbes;
+    if (pawnHash.probe(key, score))
+    {
+        ++stats.pawnHashHits;
+        return score;
+    }
+
+    const Types::Board &board = chessboard.getBoardState();
+    for (int row = 0; row < Chessboard::rows; ++row)
+    {
+        for (int col = 0; col < Chessboard::cols; ++col)
+        {
+            const Types::Piece &piece = board.board[row][col];
+            if (piece.type() != Types::PieceType::Pawn)
+                continue;
+            bool isWhite = (piece.color() == 'w');
+            float structure = evaluatePawnStructure(col, row, isWhite);
+            score += isWhite ? structure : -structure;
+        }
+    }
+
+    pawnHash.store(key, score);
+    return score;
+}
+
 float AI::evaluatePawnStructure(int col, int row, bool isWhite)
 {
     float score = 0.0f;
     int direction = isWhite ? 1 : -1;
+    const char player = isWhite ? 'w' : 'b';
+    auto isPawn = [player](const Types::Piece &piece)
+    {
+        return piece.color() == player && piece.type() == Types::PieceType::Pawn;
+    };
 
     // Check for doubled pawns
     for (int r = 0; r < Chessboard::rows; ++r)
     {
-        if (r != row &&
-            chessboard.getPiece({col, r}) == (isWhite ? "wp" : "bp"))
+        if (r != row && isPawn(chessboard.getPiece({col, r})))
         {
             // Penalty for doubled pawns
-            score -= 0.5f;
+            score += Evaluation::weights().doubledPawn;
         }
     }
 
@@ -332,7 +938,7 @@ float AI::evaluatePawnStructure(int col, int row, bool isWhite)
         {
             for (int r = 0; r < Chessboard::rows; ++r)
             {
-                if (chessboard.getPiece({c, r}) == (isWhite ? "wp" : "bp"))
+                if (isPawn(chessboard.getPiece({c, r})))
                 {
                     isolated = false;
                     break;
@@ -344,105 +950,38 @@ float AI::evaluatePawnStructure(int col, int row, bool isWhite)
     }
     if (isolated)
         // Penalty for isolated pawns
-        score -= 0.3f;
-
-    // Bonus for advanced pawns
-    int advancementBonus = isWhite ? row : (Chessboard::rows - 1 - row);
-    score += 0.1f * advancementBonus;
+        score += Evaluation::weights().isolatedPawn;
 
     // Check for pawn chains
     if (col > 0 && row + direction >= 0 && row + direction < Chessboard::rows)
     {
-        if (chessboard.getPiece({col - 1, row + direction}) ==
-            (isWhite ? "wp" : "bp"))
+        if (isPawn(chessboard.getPiece({col - 1, row + direction})))
         {
             // Bonus for being part of a pawn chain
-            score += 0.2f;
+            score += Evaluation::weights().pawnChain;
         }
     }
 
     return score;
 }
 
+// counted from pseudo-legal moves under the standard rules, a pinned piece
+// still counts its moves but the evaluation no longer plays out every one
 float AI::evaluatePieceMobility(const std::string &piece, int col, int row)
 {
-    GameLogic gameLogic;
-    float mobilityScore = 0.0f;
-    Types::Coord currentSquare = {col, row};
-    char player = piece[0];
-    // Assuming standard moves, not alternate moves
-    bool alt = false;
-
-    auto possibleMoves = gameLogic.getMoves(currentSquare,
-                                            piece,
-                                            player,
-                                            alt);
-    auto legalMoves = gameLogic.filterLegalMoves(possibleMoves,
-                                                 currentSquare,
-                                                 piece,
-                                                 player,
-                                                 alt);
-
-    // Base mobility score on the number of legal moves
-    mobilityScore += legalMoves.size() * 0.1f;
-
-    // Additional bonuses for specific pieces
-    switch (piece[1])
-    {
-    case 'R':
-        // Rooks benefit more from open lines
-        mobilityScore += legalMoves.size() * 0.05f;
-        break;
-    case 'G':
-        // Giraffe
-        // Girrafe benefit from open lines and fewer pieces on the board
-        mobilityScore += legalMoves.size() * 0.05f;
-        break;
-    case 'E':
-        // Elephant
-        // Long-range pieces benefit from more options
-        mobilityScore += legalMoves.size() * 0.03f;
-        break;
-    case 'M':
-        // Knights benefit from central positions
-        mobilityScore += legalMoves.size() * 0.04f;
-        break;
-    case 'C':
-        // Camel (3x1 Knight)
-        // Camels benefit from central positions
-        mobilityScore += legalMoves.size() * 0.03f;
-        break;
-    case 'T':
-        // Taliah (Restricted Bishop)
-        // Taliahs benefit from open diagonals
-        mobilityScore += legalMoves.size() * 0.035f;
-        break;
-    case 'W':
-        // War Machines benefit from open lines
-        mobilityScore += legalMoves.size() * 0.04f;
-        break;
-    case 'p':
-        // Pawns benefit more from forward moves
-        for (const auto &move : legalMoves)
-        {
-            if ((player == 'w' && move.y > row) ||
-                (player == 'b' && move.y < row))
-            {
-                mobilityScore += 0.15f;
-            }
-        }
-        break;
-    case 'K':
-        // King mobility is less important in the midgame/endgame
-        mobilityScore += legalMoves.size() * 0.01f;
-        break;
-    }
+    Types::PieceType type = Types::pieceTypeOf(piece[1]);
+    if (type == Types::PieceType::None)
+        return 0.0f;
+
+    int moves = Evaluation::mobility(chessboard.getBoardState(), col, row);
 
-    return mobilityScore;
+    // long range pieces gain most from open lines, the Khan hardly at all
+    return moves * Evaluation::weights().mobility[static_cast<size_t>(type)];
 }
 
 float AI::evaluateKingSafety(int col, int row, bool isWhite)
 {
+    const Evaluation::Weights &weights = Evaluation::weights();
     float safetyScore = 0.0f;
     char player = isWhite ? 'w' : 'b';
     char opponent = isWhite ? 'b' : 'w';
@@ -462,7 +1001,7 @@ float AI::evaluateKingSafety(int col, int row, bool isWhite)
                     .toString();
             if (piece[0] == player && piece[1] == 'p')
             {
-                safetyScore += 0.5f;
+                safetyScore += weights.pawnShield;
             }
         }
     }
@@ -481,7 +1020,7 @@ float AI::evaluateKingSafety(int col, int row, bool isWhite)
                                         .toString();
                 if (piece[0] == player)
                 {
-                    safetyScore += 0.2f;
+                    safetyScore += weights.khanDefender;
                 }
             }
         }
@@ -499,7 +1038,7 @@ float AI::evaluateKingSafety(int col, int row, bool isWhite)
                                         .toString();
                 if (piece[0] == opponent)
                 {
-                    safetyScore -= 0.3f;
+                    safetyScore += weights.khanAttacker;
                     // Additional penalty for specific threatening pieces
 
                     switch (piece[1])
@@ -507,12 +1046,12 @@ float AI::evaluateKingSafety(int col, int row, bool isWhite)
                     case 'R':
                     case 'G':
                     case 'E':
-                        safetyScore -= 0.2f;
+                        safetyScore += weights.khanHeavyAttacker;
                         break;
                     case 'M':
                     case 'C':
                     case 'W':
-                        safetyScore -= 0.15f;
+                        safetyScore += weights.khanLightAttacker;
                         break;
                     }
                 }
@@ -523,92 +1062,138 @@ float AI::evaluateKingSafety(int col, int row, bool isWhite)
     return safetyScore;
 }
 
-float AI::evaluateCenterControl(int col, int row)
+// scores are white-relative like evaluateBoard, white maximises and black
+// minimises, so this mirrors minMaxHelper rather than negating
+template <bool Alt, char Player>
+float AI::quiescenceSearch(float alpha,
+                           float beta,
+                           long long nodeBudgetEnd,
+                           int maxDepth,
+                           int ply)
 {
-    float centerControlScore = 0.0f;
+    ++stats.quiescenceNodes;
+    stats.selectiveDepth = std::max(stats.selectiveDepth, ply);
+    if (searchStopped())
+        return 0.0f;
+
+    // the budget of the leaf this search started from keeps capture storms
+    // from running away without starving the leaves searched after it
+    if (stats.quiescenceNodes >= nodeBudgetEnd || maxDepth == 0)
+        return evaluateBoard();
+
+    GameLogic gameLogic;
+    bool inCheck = gameLogic.isKingInCheck<Alt, Player>(chessboard.getBoardState());
 
-    // Define the center area for Tamerlane Chess (10x11 board)
-    const int centerStartCol = 3;
-    const int centerEndCol = 6;
-    const int centerStartRow = 3;
-    const int centerEndRow = 7;
+    std::vector<Types::Turn> moves;
+    float bestValue;
+    float standPat = 0.0f;
 
-    // Check if the piece is in the center area
-    if (col >= centerStartCol && col <= centerEndCol &&
-        row >= centerStartRow && row <= centerEndRow)
+    if (inCheck)
     {
-        // Assign a base score for being in the center
-        centerControlScore += 0.5f;
+        // check evasion, standing pat is not an option so every legal
+        // move is searched and having none is checkmate
+        moves = generateAllLegalMoves<Alt, Player>(0);
+        if (moves.empty())
+            return (Player == 'w') ? -MATE_SCORE : MATE_SCORE;
 
-        // Additional score based on how close to the absolute center
-        int distanceFromCenterCol = std::min(col - centerStartCol, centerEndCol - col);
-        int distanceFromCenterRow = std::min(row - centerStartRow, centerEndRow - row);
-        centerControlScore += 0.1f * (3 - distanceFromCenterCol) +
-                              0.1f * (4 - distanceFromCenterRow);
+        bestValue = (Player == 'w') ? -MATE_SCORE : MATE_SCORE;
+    }
+    else
+    {
+        standPat = evaluateBoard();
+        // the fortress holds the draw
+        if (gameLogic.canDraw(Player))
+            standPat = (Player == 'w') ? std::max(standPat, 0.0f) : std::min(standPat, 0.0f);
+        bestValue = standPat;
 
-        // Bonus for controlling the absolute center (4,5) and (5,5)
-        if ((col == 4 || col == 5) && row == 5)
+        if constexpr (Player == 'w')
         {
-            centerControlScore += 0.3f;
+            if (standPat >= beta)
+                return standPat;
+            alpha = std::max(alpha, standPat);
+        }
+        else
+        {
+            if (standPat <= alpha)
+                return standPat;
+            beta = std::min(beta, standPat);
         }
-    }
 
-    // Evaluate control of important central files (columns)
-    if (col >= 3 && col <= 6)
-    {
-        centerControlScore += 0.2f;
+        moves = generateCaptureMoves<Alt, Player>();
+
+        // most valuable victim, least valuable attacker
+        std::sort(moves.begin(), moves.end(),
+                  [](const Types::Turn &a, const Types::Turn &b)
+                  {
+                      float victimA = Evaluation::pieceValue(a.pieceCaptured);
+                      float victimB = Evaluation::pieceValue(b.pieceCaptured);
+                      if (victimA != victimB)
+                          return victimA > victimB;
+                      return Evaluation::pieceValue(a.pieceMoved) <
+                             Evaluation::pieceValue(b.pieceMoved);
+                  });
     }
 
-    // Evaluate control of important ranks (rows) for Tamerlane Chess
-    if (row >= 4 && row <= 6)
+    for (const auto &move : moves)
     {
-        centerControlScore += 0.2f;
-    }
-
-    return centerControlScore;
-}
-
-float AI::quiescenceSearch(char player, float alpha, float beta, int maxDepth)
-{
-    float standPat = evaluateBoard();
-
-    if (player == 'w')
-        alpha = std::max(alpha, standPat);
-    else
-        beta = std::min(beta, standPat);
-
-    if (beta <= alpha)
-        return standPat;
-
-    if (maxDepth == 0)
-        return standPat;
+        if (!inCheck)
+        {
+            // delta pruning, skip captures that cannot lift the score back
+            // into the window even if the captured piece comes for free
+            float gain = Evaluation::pieceValue(move.pieceCaptured) +
+                         DELTA_MARGIN;
+            if (Player == 'w' ? standPat + gain <= alpha
+                              : standPat - gain >= beta)
+                continue;
 
-    std::vector<Types::Turn> captureMoves =
-        generateCaptureMoves(player);
+            // captures that lose material once the exchange is played out
+            if (staticExchangeEvaluation<Alt>(move) < 0.0f)
+                continue;
+        }
 
-    for (const auto &move : captureMoves)
-    {
         chessboard.setCell(move.finalSquare, move.pieceMoved);
         chessboard.setCell(move.initialSquare, "---");
 
-        float score = -quiescenceSearch(player == 'w' ? 'b' : 'w',
-                                        -beta,
-                                        -alpha,
-                                        maxDepth - 1);
+        float score = quiescenceSearch<Alt, (Player == 'w') ? 'b' : 'w'>(alpha,
+                                                                         beta,
+                                                                         nodeBudgetEnd,
+                                                                         maxDepth - 1,
+                                                                         ply + 1);
 
         chessboard.setCell(move.initialSquare, move.pieceMoved);
         chessboard.setCell(move.finalSquare, move.pieceCaptured);
+        if (aborted)
+            return 0.0f;
+
+        if constexpr (Player == 'w')
+        {
+            bestValue = std::max(bestValue, score);
+            alpha = std::max(alpha, bestValue);
+        }
+        else
+        {
+            bestValue = std::min(bestValue, score);
+            beta = std::min(beta, bestValue);
+        }
 
-        if (score >= beta)
-            return beta;
-        if (score > alpha)
-            alpha = score;
+        if (beta <= alpha)
+            break;
     }
 
-    return alpha;
+    return bestValue;
 }
 
-std::vector<Types::Turn> AI::generateCaptureMoves(char player)
+std::vector<Types::Turn> AI::generateCaptureMoves(char player, bool alt)
+{
+    if (alt)
+        return (player == 'w') ? generateCaptureMoves<true, 'w'>()
+                               : generateCaptureMoves<true, 'b'>();
+    return (player == 'w') ? generateCaptureMoves<false, 'w'>()
+                           : generateCaptureMoves<false, 'b'>();
+}
+
+template <bool Alt, char Player>
+std::vector<Types::Turn> AI::generateCaptureMoves()
 {
     std::vector<Types::Turn> captureMoves;
     GameLogic gameLogic;
@@ -620,28 +1205,24 @@ std::vector<Types::Turn> AI::generateCaptureMoves(char player)
             Types::Coord currentSquare = {col, row};
             std::string piece = chessboard.getPiece(currentSquare).toString();
 
-            if (piece[0] == player)
+            if (piece[0] == Player)
             {
-                auto possibleMoves = gameLogic.getMoves(currentSquare,
-                                                        piece,
-                                                        player,
-                                                        false);
-                auto legalMoves = gameLogic.filterLegalMoves(possibleMoves,
-                                                             currentSquare,
-                                                             piece,
-                                                             player,
-                                                             false);
+                auto possibleMoves = gameLogic.getMoves<Alt, Player>(currentSquare,
+                                                                     piece);
+                auto legalMoves = gameLogic.filterLegalMoves<Alt, Player>(possibleMoves,
+                                                                          currentSquare,
+                                                                          piece);
 
                 for (const auto &move : legalMoves)
                 {
                     std::string capturedPiece =
                         chessboard.getPiece(move).toString();
-                    if (capturedPiece != "---" && capturedPiece[0] != player)
+                    if (capturedPiece != "---" && capturedPiece[0] != Player)
                     {
                         // Initialize all fields including score
                         Types::Turn turn = {
                             0,             // turn
-                            player,        // player
+                            Player,        // player
                             currentSquare, // initialSquare
                             move,          // finalSquare
                             piece,         // pieceMoved
@@ -657,3 +1238,132 @@ std::vector<Types::Turn> AI::generateCaptureMoves(char player)
 
     return captureMoves;
 }
+
+// the royal Khan is worth more than everything else so it only ever
+// recaptures last, everything else uses the search piece values
+float AI::exchangeValue(const Types::Piece &piece)
+{
+    if (piece.piece() == 'K' && piece.variant() == 'a')
+        return 100.0f;
+    return Evaluation::pieceValue(piece);
+}
+
+// static exchange evaluation, plays out every capture on the target square
+// with the least valuable attacker of each side and returns the material
+// balance for the side making `move`, pins are ignored
+float AI::staticExchangeEvaluation(const Types::Turn &move, bool alt)
+{
+    return alt ? staticExchangeEvaluation<true>(move)
+               : staticExchangeEvaluation<false>(move);
+}
+
+template <bool Alt>
+float AI::staticExchangeEvaluation(const Types::Turn &move)
+{
+    GameLogic gameLogic;
+    Types::Board board = chessboard.getBoardState();
+    const Types::Coord target = move.finalSquare;
+
+    // gain[d] is the material won by the side capturing at depth d
+    float gain[64];
+    int d = 0;
+    gain[0] = exchangeValue(move.pieceCaptured);
+
+    Types::Piece occupant = move.pieceMoved;
+    board.board[target.y][target.x] = occupant;
+    board.board[move.initialSquare.y][move.initialSquare.x] = "---";
+    char side = (move.player == 'w') ? 'b' : 'w';
+
+    while (d < 63)
+    {
+        // pawns on their way to the fork square cannot be taken
+        if (occupant.variant() == 'x')
+            break;
+
+        // least valuable attacker of `side`, rescanned every time so that
+        // sliders behind the previous capturer are picked up
+        Types::Coord attacker = {-1, -1};
+        float attackerValue = std::numeric_limits<float>::infinity();
+        for (int row = 0; row < Chessboard::rows; ++row)
+        {
+            for (int col = 0; col < Chessboard::cols; ++col)
+            {
+                const Types::Piece &piece = board.board[row][col];
+                if (piece.color() != side)
+                    continue;
+                float value = exchangeValue(piece);
+                if (value < attackerValue &&
+                    gameLogic.attacksSquare<Alt>(board, {col, row}, target))
+                {
+                    attacker = {col, row};
+                    attackerValue = value;
+                }
+            }
+        }
+
+        if (attacker.x == -1)
+            break;
+
+        ++d;
+        gain[d] = exchangeValue(occupant) - gain[d - 1];
+
+        occupant = board.board[attacker.y][attacker.x];
+        board.board[target.y][target.x] = occupant;
+        board.board[attacker.y][attacker.x] = "---";
+        side = (side == 'w') ? 'b' : 'w';
+    }
+
+    // each side may stop the exchange instead of recapturing
+    for (; d > 0; --d)
+    {
+        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+    }
+
+    return gain[0];
+}
+
+// captures that win or hold material come first (most valuable victim,
+// least valuable attacker), then quiet moves, then captures that lose
+// material according to the static exchange evaluation
+void AI::orderMoves(std::vector<Types::Turn> &moves, bool alt)
+{
+    if (alt)
+        orderMoves<true>(moves);
+    else
+        orderMoves<false>(moves);
+}
+
+template <bool Alt>
+void AI::orderMoves(std::vector<Types::Turn> &moves)
+{
+    std::vector<std::pair<float, Types::Turn>> keyed;
+    keyed.reserve(moves.size());
+
+    for (const auto &move : moves)
+    {
+        float key = 0.0f;
+        if (move.pieceCaptured != "---")
+        {
+            float see = staticExchangeEvaluation<Alt>(move);
+            if (see >= 0.0f)
+            {
+                key = 1000.0f + 10.0f * Evaluation::pieceValue(move.pieceCaptured) -
+                      Evaluation::pieceValue(move.pieceMoved);
+            }
+            else
+            {
+                key = -1000.0f + see;
+            }
+        }
+        keyed.emplace_back(key, move);
+    }
+
+    std::stable_sort(keyed.begin(), keyed.end(),
+                     [](const auto &a, const auto &b)
+                     { return a.first > b.first; });
+
+    for (size_t i = 0; i < moves.size(); ++i)
+    {
+        moves[i] = keyed[i].second;
+    }
+}
@@ -0,0 +1,127 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#include "bench.h"
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include "globals.h"
+#include "evaluation.h"
+#include "notation.h"
+#include "log.h"
+
+const std::vector<const char *> &Bench::positions()
+{
+    // five positions from each starting array and rule set, taken at plies
+    // 0, 7, 14, 25 and 41 of a game played out by a shallow search, then
+    // every sixth ply of games/game_001.csv with every other one a ply on,
+    // so both sides get searched. Changing them changes the signature
+    static const std::vector<const char *> suite = {
+        "el1ca1we1we1ca1el/rkmotagivikaadgitamork/pRpMpTpGpVpKpApEpCpWp0/11/11/11/11/P0PWPCPEPAPKPVPGPTPMPR/RkMoTaGiAdKaViGiTaMoRk/El1Ca1We1We1Ca1El w s - 1",
+        "el1ca1we1we1ca1el/1rktagivikaadgitamork/pRpMpT1pVpKpApEpCpWp0/2CapG7/11/11/11/P0PWPCPEPAPKPVPGPTPMPR/RkMoTaGiAdKa1GiTa1Rk/El3WeViWeMoCa1El b s - 8",
+        "el1ca1we1we1ca1el/1rk1givikaadgitamork/pR1pT1pV2pEpCpWp0/2pMpG1pKpA4/5taTa4/11/3PE7/P0PWPC1PAPKPVPGPTPMPR/RkMo1GiAdKaViGiTa1Rk/El3We1WeMoCa1El w s - 15",
+        "el1ca1we1we1ca1el/3givikaadgita1rk/pR1pT5pCpWp0/2pMpGpVpKpA1pE2/5ta5/11/3PETaMo1PG3/P0rkPC1PAPKPV1PTPMPR/Rk2GiAdKaViGiTa1Rk/El3We1WeMo2El b s - 26",
+        "el1ca1we1we3el/3gi3gita1rk/2pT1kaviad1pCpWp0/Rk2pGpVpK1capE2/5tapA4/1pM1Ta2Mo4/3PE3PG3/2PC1PAPKPV1PTPMPR/3GiAdKaViGiTaRk1/El3We1WeMo2El b s - 42",
+        "el1ca1we1we1ca1el/rkmotagivikaadgitamork/pRpMpTpGpVpKpApEpCpWp0/11/11/11/11/P0PWPCPEPAPKPVPGPTPMPR/RkMoTaGiAdKaViGiTaMoRk/El1Ca1We1We1Ca1El w a - 1",
+        "el1ca1we1we3el/rkmotagivikaadgitamork/1pMpTpG1pKpApEpCpWp0/7ca3/pR3pV6/1PW9/3Ca3PG3/P01PCPEPAPKPV1PTPMPR/RkMoTaGiAdKaViGiTaMoRk/El3We1We1CaEl1 b a - 8",
+        "el1ca1we1we3el/rkmo1givika1gitamork/1pMpT2pKpApEpCpWp0/3pGta1ad4/pR3pV6/1PW2PA6/2PCCa2TaPG3/P02PE1PKPV1PTPMPR/RkMoTaGiAdKaViGi1MoRk/El3We1We1CaEl1 w a - 15",
+        "el1ca1we1we3el/rkmo1givika1gitamork/2pT3pA2pWp0/3pGpK6/pRpM2Ta1adpEpC2/1PW1PEPA6/2PC2PK1PG3/P03Ad1PV1PTPMPR/RkMoTaGi1KaViGi1MoRk/1El2We1We1CaEl1 b a - 26",
+        "el1ca1we1we3el/rkmo1gi1ka1gitark1/2pT3pA2pWp0/3PEGi6/1pM5pEpC2/11/2pR2PK1PG3/P02Mo2PV1PTPMPR/Rk4KaViGi1MoRk/1El2We1We1CaEl1 b a - 42",
+        "el1ca1vikaad1ca1el/rkmotagiwepKwegitamork/pRpMpTpGpV1pApEpCpWp0/11/11/11/11/P0PWPCPEPA1PVPGPTPMPR/RkMoTaGiWePKWeGiTaMoRk/El1Ca1AdKaVi1Ca1El w s - 1",
+        "el1ca1vikaad3el/rk1tagiwepKwegitamork/pRpMpT1pV1pApEpCpWp0/2CapG5ca1/11/11/11/P0PWPCPEPA1PVPGPTPMPR/RkMoTaGiWePKWeGiTaMoRk/El3AdKaVi1Ca1El b s - 8",
+        "el1caCavikaad3el/1rk1giwepK1gitamork/pRpMpT1pV1pA1pCpWp0/3pG2wepE1ca1/5ta5/11/6We2Ca1/P0PWPCPEPA1PVPGPTPMPR/RkMoTaGiWePK1GiTaMoRk/El3AdKaVi3El w s - 15",
+        "el1ca1vi1ad3el/1rk1giwepKkagi1mork/pRpMpT1pV1pA1pCpWp0/3pG2tapE3/5ta1Ca3/9ca1/3PETa1We2Ca1/P0PWPCMoPA1PVPGPTPMPR/Rk1WeGi1PK1GiTaMoRk/El3AdKaVi3El b s - 26",
+        "el1ca1vi1ad3el/1rk1giwepKkagitamork/pR1pT3pA1pCpW1/1pM1pGpV2pE2p0/5ta5/6Ca2ca1/P01PCPETa1We2PMTa/1PW1MoPAPKPVPGPT1PR/Rk1WeGi2KaGi1MoRk/El3Ad1Vi3El b s - 42",
+        "el1ca1vikaad1ca1el/rkmotagiwepKwegitamork/pRpMpTpGpV1pApEpCpWp0/11/11/11/11/P0PWPCPEPA1PVPGPTPMPR/RkMoTaGiWePKWeGiTaMoRk/El1Ca1AdKaVi1Ca1El w a - 1",
+        "el1ca1vikaad3el/rkmotagiwepKwegitamork/pRpMpTpGpV1pApEpCpWp0/11/11/5Ta3ca1/3PE7/P0PWPC1PA1PVPGPTPMPR/RkMo1GiWePKWeGiTaMoRk/El1CaAdKa1Vi1Ca1El b a - 8",
+        "el1ca1vikaad3el/rkmotagiwepK1gitamork/pRpMpT4pEpCpWp0/6we4/3pGpV1pA4/9ca1/3PEPA1We4/P0PWPCTa2PVPGPTPMPR/RkMo1GiWePK1GiTaMoRk/El1CaAdKa1Vi1Ca1El w a - 15",
+        "1el2vikaad3el/rkmo1giwepK1gitamork/pRpMpT4pEpCpW1/1ca4we4/3pGpVPApA3p0/11/3PE2We4/P0PWPCTaViPKPVPGPTPMPR/RkMo1GiWeKa1GiTaMoca/El1Ca1Ad3Ca1El b a - 26",
+        "1el2vikaad3el/rkmo1giwepK2tamork/pRpMpT5pCpW1/1ca9/4pV1pE3p0/11/7PT2Mo/P0PWPCMoViPKKaPG1PMPR/Rk2GiWe2GiTa1ca/El1CaAd6El b a - 42",
+        "el1ca1vikaad1ca1el/rkmowetagipKgitawemork/pRpMpTpGpV1pApEpCpWp0/11/11/11/11/P0PWPCPEPA1PVPGPTPMPR/RkMoWeTaGiPKGiTaWeMoRk/El1Ca1AdKaVi1Ca1El w s - 1",
+        "el1ca1vi1kaadca1el/rkmowetagipKgitawemork/pRpMpTpGpVGipA1pCpWp0/6CapE3/11/11/11/P0PWPCPEPA1PVPGPTPMPR/RkMoWeTa1PKGiTaWeMoRk/El1CaAd1KaVi3El b s - 8",
+        "el3vi1kaadca1el/rkmowe1gipKgitawemork/pRpMpTpG1GipA1pCpWp0/4pV2pE3/4ca1ta4/5Gi5/3Ca3Ca3/P0PWPCPEPA1PVPGPTPMPR/RkMoWeTa1PK1TaWeMoRk/El2Ad1KaVi3El w s - 15",
+        "elgi2vi1ka1ca1el/rkmowe2pKgita3/pRpMpTpG1GipA1pCpWp0/4pV2pEmo2/4ca1ta4/5Gi5/3CaPA6/P0PWPCPE2PVPGPTPMPR/RkMoWeTa1PK1TaWeMoRk/El2Ad1KaVi3El b s - 26",
+        "elgi2vi1ka1ca1el/rk1we2pKgita3/pRpMpT2Gi2pC1p0/2pG1pV2pEpW2/11/1ca2TapA5/4PA1PV1Mo2/P0PWPCPE3PGPTRkPR/RkMo2WePK2We2/El2Ad1KaVi3El b s - 42",
+        "el1ca1vikaad1ca1el/rkmowetagipKgitawemork/pRpMpTpGpV1pApEpCpWp0/11/11/11/11/P0PWPCPEPA1PVPGPTPMPR/RkMoWeTaGiPKGiTaWeMoRk/El1Ca1AdKaVi1Ca1El w a - 1",
+        "el1ca1vikaad1ca1el/rkmowetagipK1tawemork/1pMpTpGpVCapApEpCpWp0/11/pR9gi/11/11/P0PWPCPEPA1PVPGPTPMPR/RkMoWeTaGiPK1TaWeMoRk/El3AdKaVi1Ca1El b a - 8",
+        "el1ca1vi1ad1ca1el/rkmowetakapK1tawemork/1pMpTpG1Gi1pEpCpWp0/6pA4/pR3pV6/4gi6/10We/P0PWPCPEPA1PVPGPTPMPR/RkMoWeTa1PK1Ta1MoRk/El3AdKaVi1Ca1El w a - 15",
+        "el1ca1vi1ad1ca1el/rk3kapK1tawemork/1pMpTpG1gi1pEpCpWp0/mo5pA4/pR3pV6/4Ta1we4/4We2CaWe2/P0PWPCPEPA2PGPTPMPR/RkMo1Ta1PK4Rk/El3AdKaVi3El b a - 26",
+        "el3vi1ad3el/rk3kapK2wemork/1pMpT2gi1pEpCpWp0/5tapAca3/pR3pV6/1moPC1pG6/4PE1We4/P0PW2PA2PGPTPMPR/1Rk1Ta1PK4Rk/El2MoAdKaVi3El b a - 42",
+        "el1ca1we1we3el/rkmo1givikaadgitamork/pRpMpT1pVpKpApEpCpWp0/3pG3ca3/5ta5/6Ca4/7PG3/P0PWPCPEPAPKPV1PTPMPR/RkMoTaGiAdKaViGiTaMoRk/El3We1We1Ca1El w s - 7",
+        "el3we1we3el/rkmo1gi1kaadgitamork/pRpMpT1pVvipApEpCpWp0/3pG3ca3/4cata5/4MoTa5/7PG3/P0PWPCPEPAPKPV1PTPMPR/Rk1TaGiAdKaViGi1MoRk/El3We1We1Ca1El b s - 14",
+        "el3we1we3el/rkmo1gika1adgitamork/pRpMpT1pV1pApEpCpWp0/4Mo1vica3/3pGcata5/5Ta5/7PG3/P0PWPCPEPAPKPV1PTPMPR/Rk1TaGiAdKaViGi1MoRk/El3We1We1Ca1El w s - 19",
+        "el3we1we3el/rk2gika1adgitamork/pRpMpT1pV1pApEpCpWp0/4Momovi4/3pGcata5/5Ta5/3PETaPKcaPG1Ca1/P0PWPC1PA1PV1PTPMPR/Rk2GiAdKaViGi1MoRk/El3We1We3El b s - 26",
+        "el3we1we3el/rk2gikaad1gitamork/pRpMpT1pV1pApEpCpWp0/4Mo1vi4/4cata5/4pGTa5/3PETa1caPG1Ca1/P0PWPC1PA1PV1PTPMPR/2RkGiAdKaViGi1MoRk/El3We1We3El w s - 31",
+        "el3we1we3el/rk2gikaad1gita1rk/pRMopT1pVvipApEpCpWp0/11/4cata5/4PETa1mo3/4Ta1caPG3/P0PWPC1PA1PV1PTPMPR/2RkGiAdKaViGi1MoRk/El3We1We3El b s - 38",
+        "el3we1we3el/rk2gikaad1gita1rk/pRMopT1pV2pEpCpWp0/4vi1pA4/2Ta1camo5/5Ta5/6caPG3/P0PWPC1PA1PV1PTPMPR/2RkGiAdKaViGi1MoRk/El3We1We3El w s - 43",
+        "el3we1we3el/3rkkaad1gita1rk/pR1pT1Ta2pEpCpWp0/4vi6/4ca1pA4/5Ta5/4mo1caPG3/P0PWPC1PA1PVViPTPMPR/2RkGiAd1KaGi1MoRk/El3We1We3El b s - 50",
+        "el3we1we3el/4kaad2ta1rk/pR1pT1gi2pEpCpWp0/4vi6/4ca1pA4/3rk1Ta5/4mo1PVPG3/P0PWPC1PA2ViPTcaPR/2RkGiAd2Gi1MoRk/El3WeKaWe3El w s - 55",
+        "el3we1we3el/4ka3ta1rk/pR1pT1giad1pEpCpWp0/4vi6/3rkca1pA4/2PC2Ta5/6PVPG3/P0PW2PA2ViPTcaPR/2RkmoKaAd1Gi1MoRk/El3We1We3El b s - 62",
+        "el3we1we3el/4ka3ta1rk/pR1pT1giad1pEpCpWp0/4vi6/4ca1pA4/2PC2Ta5/2Rk1mo1PVPG3/P0PW5ViPTcaPR/3rkKaAd1Gi1MoRk/El3We1We3El w s - 67",
+        "el3we1we3el/4ka3ta1rk/pR1pT1giad1pEpCpWp0/4vi6/4ca6/2PC2TapAPG3/2Rk3Vi4/P0PW2Ka1We1PT1PR/3rk1mo1Gi1MoRk/El3We5El b s - 74",
+        "el3we1we3el/4ka5rk/pR1pT1giad2pCpWp0/4vi2pE3/4ca6/2PC2TaWePG3/4mo1Vi4/P0PW2Ka3PT1PR/3rk3Gi1MoRk/ta3We5El w s - 79",
+        "el3we1we3el/4ka5rk/pR1pT1giad2pCpWp0/4vi6/4ca2pE3/2PC2Ta1PG3/5KaVi4/P0PW2We1We1PT1PR/4rk4MoRk/ta9El b s - 86",
+        "el3we1we3el/4ka1rk4/pR1pT1giad2pCpWp0/4vi6/4cata1pE3/2PC1WeTa1PG3/5KaVi1PT2/P0PW4We3PR/5rk3MoRk/10El w s - 91",
+        "el3wekawe3el/11/pR1pT1giad2pCpWp0/4We6/4ca2pE3/2PC2Ta1PG3/3ta2rk1PT2/P0PW4We3PR/6Ka2MoRk/10El b s - 98",
+        "el3wekawe3el/11/pR1pT2ad2pCpWp0/11/7pE3/2PC1Wegi1PG3/6rk1PT2/P0PW1ca2WeKa2PR/9MoRk/ta9El w s - 103",
+        "el3we1we3el/5ka5/pR1pT5pCpWp0/4Wead5/5ta1pE3/2PC2gi1PG3/1PW4rk1PT2/P02ca2WeKa2PR/9MoRk/10El b s - 110",
+        "el3we1we3el/5ka5/pR7pCpWp0/2pT2ad5/2PC2ta1pE3/5gi1PG3/1PW4rk1PT2/P02ca2WeKaEl1PR/9MoRk/11 w s - 115"
+    };
+    return suite;
+}
+
+Bench::Result Bench::run(int depth)
+{
+    const Types::Board savedBoard = chessboard.getBoardState();
+    const Evaluation::Weights savedWeights = Evaluation::weights();
+    Evaluation::setWeights(Evaluation::Weights());
+
+    Types::SearchOptions options;
+    options.deterministic = true;
+    options.useOpeningBook = false;
+    options.useTablebases = false;
+    options.useNnue = false;
+    AI engine(chessboard, options);
+
+    // the search logs a line for every move, which would bury the report
+    Log::Level previousLevel = Log::level();
+    Log::setLevel(Log::Level::Warning);
+
+    Result result;
+    const std::vector<const char *> &suite = positions();
+    for (size_t i = 0; i < suite.size(); ++i)
+    {
+        Notation::Position position;
+        if (!Notation::parse(suite[i], position))
+        {
+            std::cerr << "Invalid bench position " << i + 1 << ": " << suite[i] << std::endl;
+            continue;
+        }
+        chessboard.setBoard(position.board);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        engine.minMax(position.sideToMove, position.turn, position.alt, depth,
+                      -std::numeric_limits<float>::infinity(),
+                      std::numeric_limits<float>::infinity());
+        double seconds = std::chrono::duration<double>(
+                             std::chrono::high_resolution_clock::now() - start)
+                             .count();
+
+        const Types::SearchStats &stats = engine.getSearchStats();
+        long long nodes = stats.nodes + stats.quiescenceNodes;
+        result.nodes += nodes;
+        result.seconds += seconds;
+        std::cerr << "position " << i + 1 << "/" << suite.size() << ": "
+                  << nodes << " nodes" << std::endl;
+    }
+
+    Log::setLevel(previousLevel);
+    Evaluation::setWeights(savedWeights);
+    chessboard.setBoard(savedBoard);
+
+    if (result.seconds > 0.0)
+        result.nodesPerSecond = static_cast<double>(result.nodes) / result.seconds;
+    std::cerr << "\nTotal time (ms) : " << static_cast<long long>(result.seconds * 1000.0)
+              << "\nNodes searched  : " << result.nodes
+              << "\nNodes/second    : " << static_cast<long long>(result.nodesPerSecond)
+              << std::endl;
+    return result;
+}
@@ -0,0 +1,48 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#include "evalCache.h"
+#include "hashTable.h"
+#include <bit>
+
+// the score sits in the low half of the data word, the high half marks the
+// slot as written so an empty slot never matches key 0
+static constexpr uint64_t VALID = 1ULL << 32;
+
+EvalCache::EvalCache(size_t sizeMb)
+{
+    resize(sizeMb);
+}
+
+void EvalCache::resize(size_t sizeMb)
+{
+    count = hashTableSize(sizeMb * 1024 * 1024 / sizeof(Slot));
+    slots = std::make_unique<Slot[]>(count);
+    mask = count - 1;
+}
+
+void EvalCache::clear()
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        slots[i].data.store(0, std::memory_order_relaxed);
+        slots[i].check.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool EvalCache::probe(uint64_t key, float &score) const
+{
+    const Slot &slot = slots[key & mask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((data & VALID) == 0 || (check ^ data) != key)
+        return false;
+    score = std::bit_cast<float>(static_cast<uint32_t>(data));
+    return true;
+}
+
+void EvalCache::store(uint64_t key, float score)
+{
+    Slot &slot = slots[key & mask];
+    uint64_t data = VALID | std::bit_cast<uint32_t>(score);
+    slot.data.store(data, std::memory_order_relaxed);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+}
@@ -0,0 +1,412 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "evaluation.h"
+#include "chessboard.h"
+
+namespace
+{
+    constexpr int SQUARES = Chessboard::rows * Chessboard::cols;
+    constexpr int WHITE = 0;
+    constexpr int BLACK = 1;
+
+    constexpr int centerControl(int col, int row)
+    {
+        int centerControlScore = 0;
+
+        // Define the center area for Tamerlane Chess (10x11 board)
+        const int centerStartCol = 3;
+        const int centerEndCol = 6;
+        const int centerStartRow = 3;
+        const int centerEndRow = 7;
+
+        // Check if the piece is in the center area
+        if (col >= centerStartCol && col <= centerEndCol &&
+            row >= centerStartRow && row <= centerEndRow)
+        {
+            // Assign a base score for being in the center
+            centerControlScore += 50;
+
+            // Additional score based on how close to the absolute center
+            int distanceFromCenterCol = std::min(col - centerStartCol, centerEndCol - col);
+            int distanceFromCenterRow = std::min(row - centerStartRow, centerEndRow - row);
+            centerControlScore += 10 * (3 - distanceFromCenterCol) +
+                                  10 * (4 - distanceFromCenterRow);
+
+            // Bonus for controlling the absolute center (4,5) and (5,5)
+            if ((col == 4 || col == 5) && row == 5)
+            {
+                centerControlScore += 30;
+            }
+        }
+
+        // Evaluate control of important central files (columns)
+        if (col >= 3 && col <= 6)
+        {
+            centerControlScore += 20;
+        }
+
+        // Evaluate control of important ranks (rows) for Tamerlane Chess
+        if (row >= 4 && row <= 6)
+        {
+            centerControlScore += 20;
+        }
+
+        return centerControlScore;
+    }
+
+    // rows a pawn of `color` has advanced from its starting row
+    constexpr int pawnAdvancement(int color, int row)
+    {
+        return (color == WHITE) ? (Chessboard::rows - 3) - row : row - 2;
+    }
+
+    // the Khan walks to the middle of the board once the pieces are off
+    constexpr int khanActivity(int col, int row)
+    {
+        int distance = std::max(col, Chessboard::cols - 1 - col) - Chessboard::cols / 2 +
+                       std::max(row, Chessboard::rows - 1 - row) - Chessboard::rows / 2;
+        return 40 - 10 * distance;
+    }
+
+    // [color][type][square] in hundredths, from the piece's own point of view
+    using Table = std::array<std::array<std::array<int16_t, SQUARES>, Types::PIECE_TYPE_COUNT>, 2>;
+
+    constexpr Table buildTable(bool endgame)
+    {
+        Table table{};
+        for (int color = WHITE; color <= BLACK; ++color)
+        {
+            for (size_t type = 0; type < Types::PIECE_TYPE_COUNT; ++type)
+            {
+                for (int square = 0; square < SQUARES; ++square)
+                {
+                    int col = square % Chessboard::cols;
+                    int row = square / Chessboard::cols;
+                    int score = centerControl(col, row);
+                    switch (static_cast<Types::PieceType>(type))
+                    {
+                    case Types::PieceType::Pawn:
+                        // advanced pawns count double once promotion is near
+                        score += (endgame ? 20 : 10) * pawnAdvancement(color, row);
+                        break;
+                    case Types::PieceType::Khan:
+                        if (endgame)
+                            score = khanActivity(col, row);
+                        break;
+                    default:
+                        break;
+                    }
+                    table[color][type][square] = static_cast<int16_t>(score);
+                }
+            }
+        }
+        return table;
+    }
+
+    constexpr Table MIDDLEGAME_TABLE = buildTable(false);
+    constexpr Table ENDGAME_TABLE = buildTable(true);
+
+    // per thread so engines with different weights can play each other,
+    // constant initialised so reading them needs no guard
+    thread_local Evaluation::Weights activeWeights;
+
+    // material of activeWeights in hundredths, what the running sums add up
+    thread_local std::array<int, Types::PIECE_TYPE_COUNT> material = []()
+    {
+        std::array<int, Types::PIECE_TYPE_COUNT> hundredths{};
+        for (size_t type = 0; type < Types::PIECE_TYPE_COUNT; ++type)
+            hundredths[type] = static_cast<int>(Evaluation::PIECE_VALUES[type] * 100.0f + 0.5f);
+        return hundredths;
+    }();
+
+    constexpr std::array<const char *, Types::PIECE_TYPE_COUNT> TYPE_NAMES = {
+        "pawn", "rook", "talia", "khan", "mongol", "camel",
+        "giraffe", "elephant", "war_engine", "vizier", "admin"};
+}
+
+const Evaluation::Weights &Evaluation::weights()
+{
+    return activeWeights;
+}
+
+void Evaluation::setWeights(const Weights &newWeights)
+{
+    activeWeights = newWeights;
+    for (size_t type = 0; type < Types::PIECE_TYPE_COUNT; ++type)
+        material[type] = static_cast<int>(std::lround(activeWeights.material[type] * 100.0f));
+}
+
+std::vector<std::pair<std::string, float *>> Evaluation::parameters(Weights &target)
+{
+    std::vector<std::pair<std::string, float *>> named;
+    for (size_t type = 0; type < Types::PIECE_TYPE_COUNT; ++type)
+        named.emplace_back(std::string("material.") + TYPE_NAMES[type], &target.material[type]);
+    for (size_t type = 0; type < Types::PIECE_TYPE_COUNT; ++type)
+        named.emplace_back(std::string("mobility.") + TYPE_NAMES[type], &target.mobility[type]);
+    named.emplace_back("pawn.doubled", &target.doubledPawn);
+    named.emplace_back("pawn.isolated", &target.isolatedPawn);
+    named.emplace_back("pawn.chain", &target.pawnChain);
+    named.emplace_back("khan.pawn_shield", &target.pawnShield);
+    named.emplace_back("khan.defender", &target.khanDefender);
+    named.emplace_back("khan.attacker", &target.khanAttacker);
+    named.emplace_back("khan.heavy_attacker", &target.khanHeavyAttacker);
+    named.emplace_back("khan.light_attacker", &target.khanLightAttacker);
+    return named;
+}
+
+bool Evaluation::loadWeights(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+
+    Weights loaded = activeWeights;
+    auto named = parameters(loaded);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        std::string name;
+        float value;
+        if (!(fields >> name >> value))
+        {
+            std::cerr << "Bad line in " << path << ": " << line << std::endl;
+            return false;
+        }
+        auto parameter = std::find_if(named.begin(), named.end(),
+                                      [&](const auto &entry)
+                                      { return entry.first == name; });
+        if (parameter == named.end())
+        {
+            std::cerr << "Unknown evaluation weight in " << path << ": " << name << std::endl;
+            return false;
+        }
+        *parameter->second = value;
+    }
+
+    setWeights(loaded);
+    return true;
+}
+
+bool Evaluation::saveWeights(const std::string &path, const Weights &toSave)
+{
+    std::ofstream file(path);
+    if (!file)
+        return false;
+
+    Weights copy = toSave;
+    file << "# Tamerlane evaluation weights, in pawns\n";
+    for (const auto &[name, value] : parameters(copy))
+        file << name << " " << *value << "\n";
+    return static_cast<bool>(file);
+}
+
+Evaluation::Terms Evaluation::pieceSquareTerms(const Types::Piece &piece, int col, int row)
+{
+    Types::PieceType type = piece.type();
+    if (type == Types::PieceType::None)
+        return {};
+
+    const size_t index = static_cast<size_t>(type);
+    const int color = (piece.color() == 'w') ? WHITE : BLACK;
+    const int square = row * Chessboard::cols + col;
+    Terms terms;
+    terms.middlegame = material[index] + MIDDLEGAME_TABLE[color][index][square];
+    terms.endgame = material[index] + ENDGAME_TABLE[color][index][square];
+    terms.phase = PHASE_WEIGHTS[index];
+    if (color == BLACK)
+    {
+        terms.middlegame = -terms.middlegame;
+        terms.endgame = -terms.endgame;
+    }
+    return terms;
+}
+
+Evaluation::Terms Evaluation::staticTerms(const Types::Board &board)
+{
+    Terms terms;
+    for (int row = 0; row < Chessboard::rows; ++row)
+    {
+        for (int col = 0; col < Chessboard::cols; ++col)
+        {
+            terms += pieceSquareTerms(board.board[row][col], col, row);
+        }
+    }
+    return terms;
+}
+
+int Evaluation::taper(const Terms &terms)
+{
+    int phase = std::clamp(terms.phase, 0, MAX_PHASE);
+    return (terms.middlegame * phase + terms.endgame * (MAX_PHASE - phase)) / MAX_PHASE;
+}
+
+namespace
+{
+    struct Offset
+    {
+        int dx;
+        int dy;
+    };
+
+    // squares a leaper reaches from each square, precomputed so counting
+    // mobility is a walk over at most eight entries
+    struct SquareTargets
+    {
+        std::array<uint8_t, 8> squares{};
+        uint8_t count = 0;
+    };
+    using AttackTable = std::array<SquareTargets, SQUARES>;
+
+    template <size_t N>
+    constexpr AttackTable buildLeaperTable(const std::array<Offset, N> &offsets)
+    {
+        AttackTable table{};
+        for (int square = 0; square < SQUARES; ++square)
+        {
+            int col = square % Chessboard::cols;
+            int row = square / Chessboard::cols;
+            for (const Offset &offset : offsets)
+            {
+                int x = col + offset.dx;
+                int y = row + offset.dy;
+                if (x >= 0 && x < Chessboard::cols && y >= 0 && y < Chessboard::rows)
+                {
+                    SquareTargets &targets = table[square];
+                    targets.squares[targets.count++] =
+                        static_cast<uint8_t>(y * Chessboard::cols + x);
+                }
+            }
+        }
+        return table;
+    }
+
+    // standard rule leapers indexed by Types::PieceType, pawns and the
+    // sliding pieces have empty tables and are walked instead
+    constexpr std::array<AttackTable, Types::PIECE_TYPE_COUNT> LEAPER_TABLES = {
+        AttackTable{}, // pawn
+        AttackTable{}, // rook
+        AttackTable{}, // talia
+        buildLeaperTable(std::array<Offset, 8>{{{0, -1}, {0, 1}, {-1, 0}, {1, 0},
+                                                {-1, 1}, {1, 1}, {-1, -1}, {1, -1}}}),
+        buildLeaperTable(std::array<Offset, 8>{{{1, 2}, {1, -2}, {-1, 2}, {-1, -2},
+                                                {2, 1}, {2, -1}, {-2, 1}, {-2, -1}}}),
+        buildLeaperTable(std::array<Offset, 8>{{{1, 3}, {1, -3}, {-1, 3}, {-1, -3},
+                                                {3, 1}, {3, -1}, {-3, 1}, {-3, -1}}}),
+        AttackTable{}, // giraffe
+        buildLeaperTable(std::array<Offset, 4>{{{-2, 2}, {2, 2}, {-2, -2}, {2, -2}}}),
+        buildLeaperTable(std::array<Offset, 4>{{{0, -2}, {0, 2}, {-2, 0}, {2, 0}}}),
+        buildLeaperTable(std::array<Offset, 4>{{{-1, 1}, {1, 1}, {-1, -1}, {1, -1}}}),
+        buildLeaperTable(std::array<Offset, 4>{{{0, -1}, {0, 1}, {-1, 0}, {1, 0}}})};
+
+    constexpr std::array<Offset, 4> ORTHOGONAL = {{{0, -1}, {0, 1}, {-1, 0}, {1, 0}}};
+    constexpr std::array<Offset, 4> DIAGONAL = {{{-1, 1}, {1, 1}, {-1, -1}, {1, -1}}};
+
+    bool onBoard(int x, int y)
+    {
+        return x >= 0 && x < Chessboard::cols && y >= 0 && y < Chessboard::rows;
+    }
+
+    // squares reached sliding from (x, y) along the offset, starting with
+    // step `first`, the generators stop after rows - 1 steps
+    int countSlide(const Types::Board &board, char color, int x, int y,
+                   Offset step, int first)
+    {
+        int count = 0;
+        for (int i = first; i < Chessboard::rows; ++i)
+        {
+            int tx = x + step.dx * i;
+            int ty = y + step.dy * i;
+            if (!onBoard(tx, ty))
+                break;
+            const Types::Piece &target = board.board[ty][tx];
+            if (target == "---")
+            {
+                ++count;
+                continue;
+            }
+            if (target.color() != color)
+                ++count;
+            break;
+        }
+        return count;
+    }
+}
+
+int Evaluation::mobility(const Types::Board &board, int col, int row)
+{
+    const Types::Piece &piece = board.board[row][col];
+    const char color = piece.color();
+    const Types::PieceType type = piece.type();
+    int count = 0;
+
+    switch (type)
+    {
+    case Types::PieceType::None:
+        return 0;
+    case Types::PieceType::Pawn:
+    {
+        int y = row + ((color == 'w') ? -1 : 1);
+        if (y < 0 || y >= Chessboard::rows)
+            return 0;
+        if (board.board[y][col] == "---")
+            ++count;
+        for (int x : {col - 1, col + 1})
+        {
+            if (x >= 0 && x < Chessboard::cols)
+            {
+                char targetColor = board.board[y][x].color();
+                if (targetColor != '-' && targetColor != color)
+                    ++count;
+            }
+        }
+        return count;
+    }
+    case Types::PieceType::Rook:
+        for (const Offset &step : ORTHOGONAL)
+            count += countSlide(board, color, col, row, step, 1);
+        return count;
+    case Types::PieceType::Talia:
+        // the first diagonal square must be empty and cannot be stopped on
+        for (const Offset &step : DIAGONAL)
+        {
+            if (onBoard(col + step.dx, row + step.dy) &&
+                board.board[row + step.dy][col + step.dx] == "---")
+                count += countSlide(board, color, col, row, step, 2);
+        }
+        return count;
+    case Types::PieceType::Giraffe:
+        // one step diagonally, then straight on from the second square
+        for (const Offset &step : DIAGONAL)
+        {
+            int x = col + step.dx;
+            int y = row + step.dy;
+            if (!onBoard(x, y) || board.board[y][x] != "---")
+                continue;
+            if (!onBoard(x + step.dx, y) || board.board[y][x + step.dx] == "---")
+                count += countSlide(board, color, x, y, {step.dx, 0}, 2);
+            if (!onBoard(x, y + step.dy) || board.board[y + step.dy][x] == "---")
+                count += countSlide(board, color, x, y, {0, step.dy}, 2);
+        }
+        return count;
+    default:
+    {
+        const SquareTargets &targets =
+            LEAPER_TABLES[static_cast<size_t>(type)][row * Chessboard::cols + col];
+        for (uint8_t i = 0; i < targets.count; ++i)
+        {
+            int square = targets.squares[i];
+            if (board.board[square / Chessboard::cols][square % Chessboard::cols].color() != color)
+                ++count;
+        }
+        return count;
+    }
+    }
+}
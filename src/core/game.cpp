@@ -7,6 +7,7 @@
 #include "chessboard.h"
 #include "state.h"
 #include "game.h"
+#include "trace.h"
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
 #include "analysis.h"
@@ -23,6 +24,7 @@ Game::Game() : window(sf::VideoMode(State::WINDOW_WIDTH, State::WINDOW_HEIGHT),
 
 void Game::handleEvents()
 {
+    TRACE_ZONE("Game::handleEvents");
     static State::GameState previousState = State::GameState::Menu;
     
     sf::Event event;
@@ -41,6 +43,12 @@ void Game::handleEvents()
 
         utility.clickHandler(event, window);
 
+        // F3 toggles the search statistics overlay
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3)
+        {
+            State::showSearchStats = !State::showSearchStats;
+        }
+
         if (event.type == sf::Event::Closed)
         {
             window.close();
@@ -79,6 +87,7 @@ void Game::updateGameState()
         return;
     }
     frameClock.restart();
+    TRACE_ZONE("Game::updateGameState");
 
     // Update camera system
     render.updateCamera(window);
@@ -134,12 +143,19 @@ void Game::updateGameState()
     {
         // Game UI elements (exit button, etc.)
         render.drawExitButton(window);
+        if (State::showSearchStats)
+        {
+            render.drawSearchStats(window);
+        }
     }
 
     //for centering
     //render.drawGrid(window, 75);
 
-    window.display();
+    {
+        TRACE_ZONE("Game::display");
+        window.display();
+    }
 
     // Keep rendering if zooming is in progress, or if we're in menu state (for shader animations)
     if (!State::isZooming && 
@@ -152,6 +168,7 @@ void Game::updateGameState()
 
 void Game::initialize()
 {
+    TRACE_ZONE("Game::initialize");
     // Load window icon
     sf::Image icon;
     if (icon.loadFromFile("assets/images/icon.png"))
@@ -200,7 +217,10 @@ void Game::run()
         handleEvents();
 
         // Always update game logic, regardless of rendering
-        utility.handleMoves();
+        {
+            TRACE_ZONE("Utility::handleMoves");
+            utility.handleMoves();
+        }
 
         // Render only if needed, or if zooming (to ensure smooth zoom transitions)
         if (State::renderNeeded || State::animationActive || State::isZooming)
@@ -1,84 +1,84 @@
 // Copyright 2024. mirror-shades. GPL-2.0 License.
-#include <iostream>
 #include <vector>
 #include <string>
+#include <cstdlib>
+#include <array>
 #include "gameLogic.h"
 #include "pieceLogic.h"
 #include "globals.h"
 #include "state.h"
+#include "log.h"
 
 PieceLogic pieceLogic;
 
+using Generator = std::vector<Types::Coord> (PieceLogic::*)(Types::Coord);
+
+// move generators of one side indexed by Types::PieceType, the alt rules
+// swap in their own pawn, elephant, war engine, vizier and admin
+template <char Player>
+static constexpr std::array<Generator, Types::PIECE_TYPE_COUNT> standardGenerators = {
+    &PieceLogic::getPawnMoves<Player>,
+    &PieceLogic::getRookMoves<Player>,
+    &PieceLogic::getTaliaMoves<Player>,
+    &PieceLogic::getKhanMoves<Player>,
+    &PieceLogic::getMongolMoves<Player>,
+    &PieceLogic::getCamelMoves<Player>,
+    &PieceLogic::getGiraffeMoves<Player>,
+    &PieceLogic::getElephantMoves<Player>,
+    &PieceLogic::getWarEngineMoves<Player>,
+    &PieceLogic::getVizierMoves<Player>,
+    &PieceLogic::getAdminMoves<Player>};
+
+template <char Player>
+static constexpr std::array<Generator, Types::PIECE_TYPE_COUNT> altGenerators = {
+    &PieceLogic::getAltPawnMoves<Player>,
+    &PieceLogic::getRookMoves<Player>,
+    &PieceLogic::getTaliaMoves<Player>,
+    &PieceLogic::getKhanMoves<Player>,
+    &PieceLogic::getMongolMoves<Player>,
+    &PieceLogic::getCamelMoves<Player>,
+    &PieceLogic::getGiraffeMoves<Player>,
+    &PieceLogic::getAltElephantMoves<Player>,
+    &PieceLogic::getAltWarEngineMoves<Player>,
+    &PieceLogic::getAltVizierMoves<Player>,
+    &PieceLogic::getAltAdminMoves<Player>};
+
 // functionality
+// the rule set and the side are template parameters so the search picks
+// the generators once at its root, the runtime overloads below dispatch on
+// every call
+template <bool Alt, char Player>
 std::vector<Types::Coord> GameLogic::getMoves(Types::Coord coord,
-                                              Types::Piece piece,
-                                              char player,
-                                              bool alt)
+                                              Types::Piece piece)
 {
-    std::vector<Types::Coord> moveList;
-
-    if (piece.piece() == 'R')
-    {
-        moveList = pieceLogic.getRookMoves(coord, player);
-    }
-    else if (piece.piece() == 'T')
-    {
-        moveList = pieceLogic.getTaliaMoves(coord, player);
-    }
-    else if (piece.piece() == 'K')
-    {
-        moveList = pieceLogic.getKhanMoves(coord, player);
-    }
-    else if (piece.piece() == 'M')
-    {
-        moveList = pieceLogic.getMongolMoves(coord, player);
-    }
-    else if (piece.piece() == 'C')
-    {
-        moveList = pieceLogic.getCamelMoves(coord, player);
-    }
-    else if (piece.piece() == 'G')
-    {
-        moveList = pieceLogic.getGiraffeMoves(coord, player);
-    }
-    else if (piece.piece() == 'p')
-    {
-        moveList = alt ? pieceLogic.getAltPawnMoves(coord, player)
-                       : pieceLogic.getPawnMoves(coord, player);
-    }
-    else if (piece.piece() == 'E')
-    {
-        moveList = alt ? pieceLogic.getAltElephantMoves(coord, player)
-                       : pieceLogic.getElephantMoves(coord, player);
-    }
-    else if (piece.piece() == 'W')
-    {
-        moveList = alt ? pieceLogic.getAltWarEngineMoves(coord, player)
-                       : pieceLogic.getWarEngineMoves(coord, player);
-    }
-    else if (piece.piece() == 'V')
-    {
-        moveList = alt ? pieceLogic.getAltVizierMoves(coord, player)
-                       : pieceLogic.getVizierMoves(coord, player);
-    }
-    else if (piece.piece() == 'A')
-    {
-        moveList = alt ? pieceLogic.getAltAdminMoves(coord, player)
-                       : pieceLogic.getAdminMoves(coord, player);
-    }
-    else
+    Types::PieceType type = piece.type();
+    if (type == Types::PieceType::None)
     {
-        std::cerr << "Unknown piece type: " << piece.toString() << std::endl;
+        LOG_ERROR("Unknown piece type: " << piece.toString());
+        return {};
     }
 
-    return moveList;
+    const auto &generators = Alt ? altGenerators<Player> : standardGenerators<Player>;
+    return (pieceLogic.*generators[static_cast<size_t>(type)])(coord);
+}
+
+std::vector<Types::Coord> GameLogic::getMoves(Types::Coord coord,
+                                              Types::Piece piece,
+                                              char player,
+                                              bool alt)
+{
+    if (alt)
+        return (player == 'w') ? getMoves<true, 'w'>(coord, piece)
+                               : getMoves<true, 'b'>(coord, piece);
+    return (player == 'w') ? getMoves<false, 'w'>(coord, piece)
+                           : getMoves<false, 'b'>(coord, piece);
 }
 
 // returns a vector of pairs of strings and vectors of coords
 // {{"piece", {coords}}, {"piece", {coords}}, ...}
+template <bool Alt, char Player>
 std::vector<std::pair<Types::Piece, std::vector<Types::Coord>>>
-GameLogic::getAllMoves(char player,
-                       bool alt)
+GameLogic::getAllMoves()
 {
     std::vector<std::pair<Types::Piece, std::vector<Types::Coord>>> allMoves;
     auto boardState = chessboard.getBoardState();
@@ -88,13 +88,10 @@ GameLogic::getAllMoves(char player,
         for (int col = 0; col < Chessboard::cols; ++col)
         {
             Types::Piece piece = boardState.board[row][col];
-            if (piece != "---" && piece.color() == player)
+            if (piece != "---" && piece.color() == Player)
             {
                 Types::Coord coord = {col, row};
-                std::vector<Types::Coord> moves = getMoves(coord,
-                                                           piece,
-                                                           player,
-                                                           alt);
+                std::vector<Types::Coord> moves = getMoves<Alt, Player>(coord, piece);
                 if (!moves.empty())
                 {
                     allMoves.push_back({piece, moves});
@@ -105,17 +102,23 @@ GameLogic::getAllMoves(char player,
     return allMoves;
 }
 
+std::vector<std::pair<Types::Piece, std::vector<Types::Coord>>>
+GameLogic::getAllMoves(char player,
+                       bool alt)
+{
+    if (alt)
+        return (player == 'w') ? getAllMoves<true, 'w'>() : getAllMoves<true, 'b'>();
+    return (player == 'w') ? getAllMoves<false, 'w'>() : getAllMoves<false, 'b'>();
+}
+
+template <bool Alt, char Player>
 std::vector<Types::Coord>
 GameLogic::filterLegalMoves(const std::vector<Types::Coord> &possibleMoves,
                             const Types::Coord &fromCoord,
-                            const Types::Piece &piece,
-                            char player,
-                            bool alt)
+                            const Types::Piece &piece)
 {
     std::vector<Types::Coord> legalMoves;
-
-    // Backup the original state
-    const Types::Board originalBoard = chessboard.getBoardState();
+    const Types::Piece originalPiece = chessboard.getPiece(fromCoord);
 
     for (const auto &toCoord : possibleMoves)
     {
@@ -130,23 +133,44 @@ GameLogic::filterLegalMoves(const std::vector<Types::Coord> &possibleMoves,
         // Move the piece
         chessboard.setCell(fromCoord, "---");
         chessboard.setCell(toCoord, piece);
-        Types::Board newBoard = chessboard.getBoardState();
         // Check if the move results in the king being in check
-        if (!isKingInCheck(player, newBoard, alt))
+        if (!isKingInCheck<Alt, Player>(chessboard.getBoardState()))
         {
             legalMoves.push_back(toCoord);
         }
 
-        // Revert the move
-        chessboard.setBoard(originalBoard);
+        // Revert the move, cell by cell so the board's running evaluation
+        // is updated instead of rescanned
+        chessboard.setCell(toCoord, targetPiece);
+        chessboard.setCell(fromCoord, originalPiece);
     }
 
-    // Restore the original board state just to be absolutely sure
-    chessboard.setBoard(originalBoard);
-
     return legalMoves;
 }
 
+std::vector<Types::Coord>
+GameLogic::filterLegalMoves(const std::vector<Types::Coord> &possibleMoves,
+                            const Types::Coord &fromCoord,
+                            const Types::Piece &piece,
+                            char player,
+                            bool alt)
+{
+    if (alt)
+        return (player == 'w') ? filterLegalMoves<true, 'w'>(possibleMoves, fromCoord, piece)
+                               : filterLegalMoves<true, 'b'>(possibleMoves, fromCoord, piece);
+    return (player == 'w') ? filterLegalMoves<false, 'w'>(possibleMoves, fromCoord, piece)
+                           : filterLegalMoves<false, 'b'>(possibleMoves, fromCoord, piece);
+}
+
+void GameLogic::playMove(const Types::Turn &move)
+{
+    char enemy = (move.player == 'w') ? 'b' : 'w';
+    chessboard.setCell(move.initialSquare, "---");
+    chessboard.setCell(move.finalSquare, move.pieceMoved);
+    promotePawns(move.player);
+    checkPawnForks(enemy);
+}
+
 void GameLogic::promotePawns(char player)
 {
     int row = (player == 'w') ? 0 : 9;
@@ -203,8 +227,7 @@ void GameLogic::promotePawns(char player)
             if (targetPiece.piece() == 'K')
             {
                 chessboard.setCell({col, row}, "---");
-                std::cout << "Space occupied by king, pawn executed!"
-                          << std::endl;
+                LOG_INFO("Space occupied by king, pawn executed!");
             }
             else
             {
@@ -220,17 +243,17 @@ void GameLogic::promotePawns(char player)
             checkPawnForks(enemy);
             continue;
         default:
-            std::cout << "Invalid pawn type: "
+            LOG_ERROR("Invalid pawn type: "
                       << piece.toString() << " at "
-                      << col << "," << row << std::endl;
+                      << col << "," << row);
             continue;
         }
 
         chessboard.setCell({col, row}, Types::Piece(player + promotionType));
-        std::cout << "Promoted "
-                  << piece.toString() << " to "
-                  << player + promotionType << " at "
-                  << col << "," << row << std::endl;
+        LOG_INFO("Promoted "
+                 << piece.toString() << " to "
+                 << player + promotionType << " at "
+                 << col << "," << row);
     }
 }
 
@@ -241,7 +264,7 @@ void GameLogic::checkPawnForks(char player)
 
     if (pawnXPos.x == -1 || pawnXPos.y == -1)
     {
-        std::cout << "No pawnX found for player " << player << std::endl;
+        LOG_DEBUG("No pawnX found for player " << player);
         return;
     }
 
@@ -280,7 +303,7 @@ void GameLogic::checkPawnForks(char player)
             }
         }
     }
-    std::cout << "No valid pawn fork found for player " << player << std::endl;
+    LOG_DEBUG("No valid pawn fork found for player " << player);
 }
 
 Types::Coord GameLogic::findPawnX(char player)
@@ -318,9 +341,8 @@ void GameLogic::findAndSetKingPosition(Types::Coord &kingPosition, const char &p
     }
 }
 
-bool GameLogic::isKingInCheck(const char &player,
-                              const Types::Board &boardState,
-                              bool alt)
+template <bool Alt, char Player>
+bool GameLogic::isKingInCheck(const Types::Board &boardState)
 {
     // Find the king's position
     Types::Coord kingPosition;
@@ -331,7 +353,7 @@ bool GameLogic::isKingInCheck(const char &player,
         for (int col = 0; col < Chessboard::cols; ++col)
         {
             Types::Piece piece = boardState.board[row][col];
-            if (piece.color() == player && piece.piece() == 'K')
+            if (piece.color() == Player && piece.piece() == 'K')
             {
                 kingPosition = {col, row};
                 kingFound = true;
@@ -344,11 +366,11 @@ bool GameLogic::isKingInCheck(const char &player,
 
     if (!kingFound)
     {
-        std::cout << "Error: King not found!\n";
+        LOG_ERROR("King not found!");
         return false;
     }
 
-    char enemyPlayer = (player == 'w') ? 'b' : 'w';
+    constexpr char enemyPlayer = (Player == 'w') ? 'b' : 'w';
     for (int row = 0; row < Chessboard::rows; ++row)
     {
         for (int col = 0; col < Chessboard::cols; ++col)
@@ -356,10 +378,7 @@ bool GameLogic::isKingInCheck(const char &player,
             Types::Piece piece = boardState.board[row][col];
             if (piece.color() == enemyPlayer)
             {
-                std::vector<Types::Coord> moves = getMoves({col, row},
-                                                           piece,
-                                                           enemyPlayer,
-                                                           alt);
+                std::vector<Types::Coord> moves = getMoves<Alt, enemyPlayer>({col, row}, piece);
                 for (const auto &move : moves)
                 {
                     if (move == kingPosition)
@@ -374,49 +393,166 @@ bool GameLogic::isKingInCheck(const char &player,
     return false;
 }
 
-bool GameLogic::hasLegalMoves(char player, bool alt)
+bool GameLogic::isKingInCheck(const char &player,
+                              const Types::Board &boardState,
+                              bool alt)
 {
-    std::vector<std::pair<Types::Piece, std::vector<Types::Coord>>>
-        allMoves = getAllMoves(player, alt);
+    if (alt)
+        return (player == 'w') ? isKingInCheck<true, 'w'>(boardState)
+                               : isKingInCheck<true, 'b'>(boardState);
+    return (player == 'w') ? isKingInCheck<false, 'w'>(boardState)
+                           : isKingInCheck<false, 'b'>(boardState);
+}
 
-    for (const auto &pieceMoves : allMoves)
-    {
-        const Types::Piece &piece = pieceMoves.first;
-        const std::vector<Types::Coord> &possibleMoves = pieceMoves.second;
+// checks whether the piece standing on `from` could capture on `to`
+// works on the given board only so exchanges can be played out on a copy
+// mirrors the reach of the PieceLogic generators without building move lists.
+// The side is the colour of that piece, so only the rule set is a parameter
+template <bool Alt>
+bool GameLogic::attacksSquare(const Types::Board &boardState,
+                              Types::Coord from,
+                              Types::Coord to)
+{
+    const Types::Piece &piece = boardState.board[from.y][from.x];
+    const int dx = to.x - from.x;
+    const int dy = to.y - from.y;
+    const int adx = std::abs(dx);
+    const int ady = std::abs(dy);
+
+    if (adx == 0 && ady == 0)
+        return false;
 
-        Types::Coord fromCoord;
-        bool pieceFound = false;
-        for (int row = 0; row < Chessboard::rows && !pieceFound; ++row)
+    auto isEmpty = [&boardState](int x, int y)
+    {
+        return x >= 0 && x < Chessboard::cols &&
+               y >= 0 && y < Chessboard::rows &&
+               boardState.board[y][x] == "---";
+    };
+
+    // slides from `start` along (stepX, stepY) and reports whether `to` is
+    // reached before a blocker, the generators stop after rows - 1 steps
+    auto slides = [&](int startX, int startY, int stepX, int stepY, int first)
+    {
+        for (int i = first; i < Chessboard::rows; ++i)
         {
-            for (int col = 0; col < Chessboard::cols; ++col)
-            {
-                if (chessboard.getPiece({col, row}) == piece)
-                {
-                    fromCoord = {col, row};
-                    pieceFound = true;
-                    break;
-                }
-            }
+            int x = startX + stepX * i;
+            int y = startY + stepY * i;
+            if (x == to.x && y == to.y)
+                return true;
+            if (!isEmpty(x, y))
+                return false;
         }
+        return false;
+    };
 
-        if (!pieceFound)
-            continue;
+    switch (piece.type())
+    {
+    case Types::PieceType::Pawn:
+    {
+        int direction = (piece.color() == 'w') ? -1 : 1;
+        return dy == direction && adx == 1;
+    }
+    case Types::PieceType::Rook:
+        if (dx != 0 && dy != 0)
+            return false;
+        return slides(from.x, from.y, (dx > 0) - (dx < 0), (dy > 0) - (dy < 0), 1);
+    case Types::PieceType::Talia:
+    {
+        // Talia cannot stop on the first diagonal square and is blocked by it
+        if (adx != ady || adx < 2)
+            return false;
+        int stepX = dx > 0 ? 1 : -1;
+        int stepY = dy > 0 ? 1 : -1;
+        return isEmpty(from.x + stepX, from.y + stepY) &&
+               slides(from.x, from.y, stepX, stepY, 2);
+    }
+    case Types::PieceType::Khan:
+        return adx <= 1 && ady <= 1;
+    case Types::PieceType::Mongol:
+        return (adx == 1 && ady == 2) || (adx == 2 && ady == 1);
+    case Types::PieceType::Camel:
+        return (adx == 1 && ady == 3) || (adx == 3 && ady == 1);
+    case Types::PieceType::Elephant:
+        if (adx == 2 && ady == 2)
+            return true;
+        return Alt && adx + ady == 1;
+    case Types::PieceType::Vizier:
+        if (adx == 1 && ady == 1)
+            return true;
+        return Alt && adx == 2 && ady == 2;
+    case Types::PieceType::WarEngine:
+        if ((adx == 2 && ady == 0) || (adx == 0 && ady == 2))
+            return true;
+        return Alt && adx == 2 && ady == 2;
+    case Types::PieceType::Admin:
+        if (adx + ady == 1)
+            return true;
+        return Alt && ((adx == 2 && ady == 0) || (adx == 0 && ady == 2));
+    case Types::PieceType::Giraffe:
+    {
+        // one step diagonally, then at least two more squares straight on,
+        // the diagonal square and the square next to it must both be empty
+        if (adx < 1 || ady < 1 || (adx != 1 && ady != 1))
+            return false;
+        int stepX = dx > 0 ? 1 : -1;
+        int stepY = dy > 0 ? 1 : -1;
+        int diagX = from.x + stepX;
+        int diagY = from.y + stepY;
+        if (!isEmpty(diagX, diagY))
+            return false;
+        if (ady == 1 && adx >= 3)
+            return isEmpty(diagX + stepX, diagY) &&
+                   slides(diagX, diagY, stepX, 0, 2);
+        if (adx == 1 && ady >= 3)
+            return isEmpty(diagX, diagY + stepY) &&
+                   slides(diagX, diagY, 0, stepY, 2);
+        return false;
+    }
+    default:
+        return false;
+    }
+}
 
-        std::vector<Types::Coord> legalMoves = filterLegalMoves(possibleMoves,
-                                                                fromCoord,
-                                                                piece,
-                                                                player,
-                                                                alt);
+bool GameLogic::attacksSquare(const Types::Board &boardState,
+                              Types::Coord from,
+                              Types::Coord to,
+                              bool alt)
+{
+    return alt ? attacksSquare<true>(boardState, from, to)
+               : attacksSquare<false>(boardState, from, to);
+}
 
-        if (!legalMoves.empty())
+template <bool Alt, char Player>
+bool GameLogic::hasLegalMoves()
+{
+    // walks the squares rather than getAllMoves, whose pieces do not say
+    // where they stand, so a second piece of the same kind is not filtered
+    // as if it stood on the first
+    for (int row = 0; row < Chessboard::rows; ++row)
+    {
+        for (int col = 0; col < Chessboard::cols; ++col)
         {
-            return true;
+            Types::Coord fromCoord = {col, row};
+            Types::Piece piece = chessboard.getPiece(fromCoord);
+            if (piece.color() != Player)
+                continue;
+
+            std::vector<Types::Coord> possibleMoves = getMoves<Alt, Player>(fromCoord, piece);
+            if (!filterLegalMoves<Alt, Player>(possibleMoves, fromCoord, piece).empty())
+                return true;
         }
     }
 
     return false;
 }
 
+bool GameLogic::hasLegalMoves(char player, bool alt)
+{
+    if (alt)
+        return (player == 'w') ? hasLegalMoves<true, 'w'>() : hasLegalMoves<true, 'b'>();
+    return (player == 'w') ? hasLegalMoves<false, 'w'>() : hasLegalMoves<false, 'b'>();
+}
+
 bool GameLogic::canDraw(char player)
 {
     if (player == 'w')
@@ -474,3 +610,23 @@ bool GameLogic::checkThreefoldRepetition(const Types::Board &boardState, char pl
     // If this position has occurred 2 times before (making this the 3rd), it's a threefold repetition
     return count >= 2;
 }
+
+// both rule sets and sides are instantiated here so the templates can stay
+// out of the header
+#define INSTANTIATE_GAME_LOGIC(Alt, Player)                                                              \
+    template std::vector<Types::Coord> GameLogic::getMoves<Alt, Player>(Types::Coord, Types::Piece);     \
+    template std::vector<std::pair<Types::Piece, std::vector<Types::Coord>>>                             \
+    GameLogic::getAllMoves<Alt, Player>();                                                               \
+    template std::vector<Types::Coord> GameLogic::filterLegalMoves<Alt, Player>(                         \
+        const std::vector<Types::Coord> &, const Types::Coord &, const Types::Piece &);                  \
+    template bool GameLogic::isKingInCheck<Alt, Player>(const Types::Board &);                           \
+    template bool GameLogic::hasLegalMoves<Alt, Player>();
+
+INSTANTIATE_GAME_LOGIC(false, 'w')
+INSTANTIATE_GAME_LOGIC(false, 'b')
+INSTANTIATE_GAME_LOGIC(true, 'w')
+INSTANTIATE_GAME_LOGIC(true, 'b')
+#undef INSTANTIATE_GAME_LOGIC
+
+template bool GameLogic::attacksSquare<false>(const Types::Board &, Types::Coord, Types::Coord);
+template bool GameLogic::attacksSquare<true>(const Types::Board &, Types::Coord, Types::Coord);
@@ -0,0 +1,276 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#include "nnue.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "chessboard.h"
+#include "evaluation.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define NNUE_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+const Nnue::Network *Nnue::active = nullptr;
+
+namespace
+{
+    std::unique_ptr<Nnue::Network> loadedNetwork;
+
+    int pieceKind(const Types::Piece &piece)
+    {
+        Types::PieceType type = piece.type();
+        if (type != Types::PieceType::Pawn)
+            return static_cast<int>(type) - 1;
+
+        // pawns are told apart by the piece they promote to
+        Types::PieceType promotesTo = Types::pieceTypeOf(piece.code[2]);
+        if (promotesTo == Types::PieceType::None || promotesTo == Types::PieceType::Pawn)
+            return Nnue::PIECE_KINDS - 1;
+        return 9 + static_cast<int>(promotesTo);
+    }
+}
+
+bool Nnue::load(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    Header header{};
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 ||
+        header.features != FEATURES || header.hidden != HIDDEN || header.hidden2 != HIDDEN2)
+    {
+        std::cerr << "Invalid network: " << path << std::endl;
+        return false;
+    }
+
+    auto network = std::make_unique<Network>();
+    file.read(reinterpret_cast<char *>(network->featureBiases.data()), sizeof(network->featureBiases));
+    file.read(reinterpret_cast<char *>(network->featureWeights.data()), sizeof(network->featureWeights));
+    file.read(reinterpret_cast<char *>(network->hiddenWeights.data()), sizeof(network->hiddenWeights));
+    file.read(reinterpret_cast<char *>(network->hiddenBiases.data()), sizeof(network->hiddenBiases));
+    file.read(reinterpret_cast<char *>(network->outputWeights.data()), sizeof(network->outputWeights));
+    file.read(reinterpret_cast<char *>(&network->outputBias), sizeof(network->outputBias));
+    if (!file || file.peek() != std::char_traits<char>::eof())
+    {
+        std::cerr << "Invalid network: " << path << std::endl;
+        return false;
+    }
+
+    setNetwork(std::move(network));
+    return true;
+}
+
+void Nnue::setNetwork(std::unique_ptr<Network> network)
+{
+    loadedNetwork = std::move(network);
+    active = loadedNetwork.get();
+}
+
+bool Nnue::write(const std::string &path, const Network &network)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open network for writing: " << path << std::endl;
+        return false;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.features = FEATURES;
+    header.hidden = HIDDEN;
+    header.hidden2 = HIDDEN2;
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(network.featureBiases.data()), sizeof(network.featureBiases));
+    file.write(reinterpret_cast<const char *>(network.featureWeights.data()), sizeof(network.featureWeights));
+    file.write(reinterpret_cast<const char *>(network.hiddenWeights.data()), sizeof(network.hiddenWeights));
+    file.write(reinterpret_cast<const char *>(network.hiddenBiases.data()), sizeof(network.hiddenBiases));
+    file.write(reinterpret_cast<const char *>(network.outputWeights.data()), sizeof(network.outputWeights));
+    file.write(reinterpret_cast<const char *>(&network.outputBias), sizeof(network.outputBias));
+    return file.good();
+}
+
+// hidden neuron color * 11 + type counts that piece type eight times over,
+// which stays below the clip for up to fifteen pieces. The second layer
+// passes the counts on scaled by 10 / 8 and the output weighs them by
+// value, 20 per pawn of value, so the output is 200 per pawn
+std::unique_ptr<Nnue::Network> Nnue::materialNetwork()
+{
+    auto network = std::make_unique<Network>();
+
+    for (int color = 0; color < 2; ++color)
+    {
+        for (int kind = 0; kind < PIECE_KINDS; ++kind)
+        {
+            // the piece kinds of pieceKind, pawns of any variant are pawns
+            int type = kind < 10 ? kind + 1 : 0;
+            int neuron = color * static_cast<int>(Types::PIECE_TYPE_COUNT) + type;
+            for (int square = 0; square < SQUARES; ++square)
+                network->featureWeights[(color * PIECE_KINDS + kind) * SQUARES + square][neuron] = 8;
+        }
+        for (size_t type = 0; type < Types::PIECE_TYPE_COUNT; ++type)
+        {
+            size_t neuron = color * Types::PIECE_TYPE_COUNT + type;
+            network->hiddenWeights[neuron][neuron] = 80;
+            float value = Evaluation::PIECE_VALUES[type] * 20.0f;
+            network->outputWeights[neuron] = static_cast<int8_t>(color == 0 ? value : -value);
+        }
+    }
+    return network;
+}
+
+int Nnue::feature(const Types::Piece &piece, int col, int row)
+{
+    char color = piece.color();
+    if (color != 'w' && color != 'b')
+        return -1;
+    int side = color == 'w' ? 0 : 1;
+    return (side * PIECE_KINDS + pieceKind(piece)) * SQUARES + row * Chessboard::cols + col;
+}
+
+void Nnue::refresh(const Types::Board &board, Accumulator &accumulator)
+{
+    accumulator.values = active->featureBiases;
+    for (int row = 0; row < Chessboard::rows; ++row)
+    {
+        for (int col = 0; col < Chessboard::cols; ++col)
+        {
+            int index = feature(board.board[row][col], col, row);
+            if (index >= 0)
+                addFeature(accumulator, index);
+        }
+    }
+}
+
+// plain loops, the compiler vectorises them for the baseline instruction set
+void Nnue::addFeature(Accumulator &accumulator, int feature)
+{
+    const auto &weights = active->featureWeights[feature];
+    for (int i = 0; i < HIDDEN; ++i)
+        accumulator.values[i] = static_cast<int16_t>(accumulator.values[i] + weights[i]);
+}
+
+void Nnue::removeFeature(Accumulator &accumulator, int feature)
+{
+    const auto &weights = active->featureWeights[feature];
+    for (int i = 0; i < HIDDEN; ++i)
+        accumulator.values[i] = static_cast<int16_t>(accumulator.values[i] - weights[i]);
+}
+
+int32_t Nnue::forwardScalar(const Accumulator &accumulator)
+{
+    const Network &network = *active;
+    std::array<uint8_t, HIDDEN> input;
+    for (int i = 0; i < HIDDEN; ++i)
+        input[i] = static_cast<uint8_t>(std::clamp<int>(accumulator.values[i], 0, ACTIVATION_MAX));
+
+    int32_t output = network.outputBias;
+    for (int neuron = 0; neuron < HIDDEN2; ++neuron)
+    {
+        int32_t sum = network.hiddenBiases[neuron];
+        for (int i = 0; i < HIDDEN; ++i)
+            sum += input[i] * network.hiddenWeights[neuron][i];
+        int32_t hidden = std::clamp(sum >> HIDDEN_SHIFT, 0, ACTIVATION_MAX);
+        output += hidden * network.outputWeights[neuron];
+    }
+    return output;
+}
+
+#ifdef NNUE_X86
+namespace
+{
+    TARGET_AVX2 int32_t horizontalSum(__m256i sums)
+    {
+        __m128i quad = _mm_add_epi32(_mm256_castsi256_si128(sums),
+                                     _mm256_extracti128_si256(sums, 1));
+        quad = _mm_add_epi32(quad, _mm_shuffle_epi32(quad, _MM_SHUFFLE(1, 0, 3, 2)));
+        quad = _mm_add_epi32(quad, _mm_shuffle_epi32(quad, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(quad);
+    }
+
+    // the clipped activations fit in a byte, so the second layer multiplies
+    // 32 of them at a time with maddubs. Two products of at most 127 * 127
+    // never saturate its 16 bit sums
+    TARGET_AVX2 int32_t forwardAvx2(const Nnue::Network &network,
+                                    const Nnue::Accumulator &accumulator)
+    {
+        constexpr int BLOCKS = Nnue::HIDDEN / 32;
+        const __m256i activationMax = _mm256_set1_epi8(Nnue::ACTIVATION_MAX);
+        const __m256i ones = _mm256_set1_epi16(1);
+
+        __m256i input[BLOCKS];
+        for (int block = 0; block < BLOCKS; ++block)
+        {
+            const __m256i *values = reinterpret_cast<const __m256i *>(accumulator.values.data()) + block * 2;
+            // packus clips below 0 and interleaves the 128 bit lanes, the
+            // permute puts them back in order
+            __m256i packed = _mm256_packus_epi16(_mm256_load_si256(values),
+                                                 _mm256_load_si256(values + 1));
+            packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+            input[block] = _mm256_min_epu8(packed, activationMax);
+        }
+
+        int32_t output = network.outputBias;
+        for (int neuron = 0; neuron < Nnue::HIDDEN2; ++neuron)
+        {
+            const __m256i *weights = reinterpret_cast<const __m256i *>(network.hiddenWeights[neuron].data());
+            __m256i sums = _mm256_setzero_si256();
+            for (int block = 0; block < BLOCKS; ++block)
+            {
+                __m256i products = _mm256_maddubs_epi16(input[block], _mm256_load_si256(weights + block));
+                sums = _mm256_add_epi32(sums, _mm256_madd_epi16(products, ones));
+            }
+            int32_t sum = network.hiddenBiases[neuron] + horizontalSum(sums);
+            int32_t hidden = std::clamp(sum >> Nnue::HIDDEN_SHIFT, 0, Nnue::ACTIVATION_MAX);
+            output += hidden * network.outputWeights[neuron];
+        }
+        return output;
+    }
+
+    bool detectAvx2()
+    {
+#if defined(_MSC_VER)
+        int registers[4];
+        __cpuidex(registers, 7, 0);
+        return (registers[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    const bool hasAvx2 = detectAvx2();
+}
+#endif
+
+int32_t Nnue::forwardSimd(const Accumulator &accumulator)
+{
+#ifdef NNUE_X86
+    if (hasAvx2)
+        return forwardAvx2(*active, accumulator);
+#endif
+    return forwardScalar(accumulator);
+}
+
+bool Nnue::simdAvailable()
+{
+#ifdef NNUE_X86
+    return hasAvx2;
+#else
+    return false;
+#endif
+}
+
+float Nnue::evaluate(const Accumulator &accumulator)
+{
+    return static_cast<float>(forwardSimd(accumulator)) / OUTPUT_SCALE;
+}
@@ -0,0 +1,204 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#include "notation.h"
+#include <charconv>
+#include "chessboard.h"
+
+namespace
+{
+    bool isUpper(char c) { return c >= 'A' && c <= 'Z'; }
+    bool isLower(char c) { return c >= 'a' && c <= 'z'; }
+    bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    // the second characters that go with the first of a piece code
+    bool validCode(char first, char second)
+    {
+        switch (first)
+        {
+        case 'p':
+            switch (second)
+            {
+            case 'R': case 'M': case 'T': case 'G': case 'V': case 'K': case 'A':
+            case 'E': case 'C': case 'W': case '0': case '1': case '2': case 'x':
+                return true;
+            default:
+                return false;
+            }
+        case 'R':
+            return second == 'k';
+        case 'M':
+            return second == 'o';
+        case 'T':
+        case 'C':
+            return second == 'a';
+        case 'G':
+        case 'V':
+            return second == 'i';
+        case 'K':
+            return second == 'a' || second == '0' || second == '1';
+        case 'A':
+            return second == 'd';
+        case 'E':
+            return second == 'l';
+        case 'W':
+            return second == 'e';
+        default:
+            return false;
+        }
+    }
+}
+
+bool Notation::parse(std::string_view text, Position &position)
+{
+    const char *p = text.data();
+    const char *end = p + text.size();
+
+    for (int row = 0; row < Chessboard::rows; ++row)
+    {
+        if (row > 0 && (p == end || *p++ != '/'))
+            return false;
+
+        int col = 0;
+        while (col < Chessboard::cols)
+        {
+            if (p == end)
+                return false;
+            char c = *p++;
+            if (isDigit(c))
+            {
+                int empty = c - '0';
+                if (p != end && isDigit(*p))
+                    empty = empty * 10 + (*p++ - '0');
+                if (empty < 1 || col + empty > Chessboard::cols)
+                    return false;
+                for (; empty > 0; --empty)
+                    position.board.board[row][col++] = Types::Piece();
+                continue;
+            }
+
+            // the code's own first character is upper case except for pawns
+            if ((!isUpper(c) && !isLower(c)) || p == end)
+                return false;
+            char first = (c == 'p' || c == 'P') ? 'p' : static_cast<char>(c & ~0x20);
+            char second = *p++;
+            if (!validCode(first, second))
+                return false;
+            char *code = position.board.board[row][col++].code;
+            code[0] = isUpper(c) ? 'w' : 'b';
+            code[1] = first;
+            code[2] = second;
+            code[3] = '\0';
+        }
+    }
+
+    // side to move, the only field that has to be there
+    if (end - p < 2 || p[0] != ' ' || (p[1] != 'w' && p[1] != 'b'))
+        return false;
+    position.sideToMove = p[1];
+    p += 2;
+
+    position.alt = false;
+    if (p != end)
+    {
+        if (end - p < 2 || p[0] != ' ' || (p[1] != 's' && p[1] != 'a'))
+            return false;
+        position.alt = p[1] == 'a';
+        p += 2;
+    }
+
+    position.whiteInFortress = false;
+    position.blackInFortress = false;
+    if (p != end)
+    {
+        if (*p++ != ' ' || p == end)
+            return false;
+        if (*p == '-')
+            ++p;
+        else
+        {
+            if (p != end && *p == 'w')
+            {
+                position.whiteInFortress = true;
+                ++p;
+            }
+            if (p != end && *p == 'b')
+            {
+                position.blackInFortress = true;
+                ++p;
+            }
+            if (!position.whiteInFortress && !position.blackInFortress)
+                return false;
+        }
+    }
+
+    position.turn = 1;
+    if (p != end)
+    {
+        if (*p++ != ' ')
+            return false;
+        auto [last, error] = std::from_chars(p, end, position.turn);
+        if (error != std::errc() || position.turn < 1)
+            return false;
+        p = last;
+    }
+
+    return p == end;
+}
+
+size_t Notation::write(const Position &position, char *buffer, size_t size)
+{
+    if (size < MAX_LENGTH)
+        return 0;
+
+    char *p = buffer;
+    for (int row = 0; row < Chessboard::rows; ++row)
+    {
+        if (row > 0)
+            *p++ = '/';
+
+        int empty = 0;
+        for (int col = 0; col < Chessboard::cols; ++col)
+        {
+            const Types::Piece &piece = position.board.board[row][col];
+            char color = piece.color();
+            if (color != 'w' && color != 'b')
+            {
+                ++empty;
+                continue;
+            }
+            if (empty > 0)
+            {
+                p = std::to_chars(p, buffer + size, empty).ptr;
+                empty = 0;
+            }
+            char first = piece.code[1];
+            if (color == 'w')
+                *p++ = (first == 'p') ? 'P' : first;
+            else
+                *p++ = (first == 'p') ? 'p' : static_cast<char>(first | 0x20);
+            *p++ = piece.code[2];
+        }
+        if (empty > 0)
+            p = std::to_chars(p, buffer + size, empty).ptr;
+    }
+
+    *p++ = ' ';
+    *p++ = position.sideToMove;
+    *p++ = ' ';
+    *p++ = position.alt ? 'a' : 's';
+    *p++ = ' ';
+    if (!position.whiteInFortress && !position.blackInFortress)
+        *p++ = '-';
+    if (position.whiteInFortress)
+        *p++ = 'w';
+    if (position.blackInFortress)
+        *p++ = 'b';
+    *p++ = ' ';
+    p = std::to_chars(p, buffer + size, position.turn).ptr;
+    return static_cast<size_t>(p - buffer);
+}
+
+std::string Notation::toString(const Position &position)
+{
+    char buffer[MAX_LENGTH];
+    return std::string(buffer, write(position, buffer, sizeof(buffer)));
+}
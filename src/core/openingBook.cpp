@@ -0,0 +1,76 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#include "openingBook.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <tuple>
+
+static bool entryLess(const OpeningBook::Entry &a, const OpeningBook::Entry &b)
+{
+    return std::tie(a.key, a.fromX, a.fromY, a.toX, a.toY) <
+           std::tie(b.key, b.fromX, b.fromY, b.toX, b.toY);
+}
+
+bool OpeningBook::open(const std::string &path)
+{
+    close();
+    if (!file.open(path))
+        return false;
+
+    const Header *header = static_cast<const Header *>(file.data());
+    if (file.size() < sizeof(Header) ||
+        std::memcmp(header->magic, MAGIC, sizeof(header->magic)) != 0 ||
+        file.size() != sizeof(Header) + header->count * sizeof(Entry))
+    {
+        std::cerr << "Invalid opening book: " << path << std::endl;
+        close();
+        return false;
+    }
+
+    entries = reinterpret_cast<const Entry *>(static_cast<const char *>(file.data()) + sizeof(Header));
+    count = static_cast<size_t>(header->count);
+    return true;
+}
+
+void OpeningBook::close()
+{
+    file.close();
+    entries = nullptr;
+    count = 0;
+}
+
+std::vector<OpeningBook::Entry> OpeningBook::probe(uint64_t key) const
+{
+    std::vector<Entry> moves;
+    if (!isOpen())
+        return moves;
+
+    // binary search for the first entry of the position, its moves follow
+    const Entry *first = std::lower_bound(entries, entries + count, key,
+                                          [](const Entry &entry, uint64_t value)
+                                          { return entry.key < value; });
+    for (const Entry *entry = first; entry != entries + count && entry->key == key; ++entry)
+        moves.push_back(*entry);
+    return moves;
+}
+
+bool OpeningBook::write(const std::string &path, std::vector<Entry> bookEntries)
+{
+    std::sort(bookEntries.begin(), bookEntries.end(), entryLess);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open book for writing: " << path << std::endl;
+        return false;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.count = bookEntries.size();
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(bookEntries.data()),
+               static_cast<std::streamsize>(bookEntries.size() * sizeof(Entry)));
+    return file.good();
+}
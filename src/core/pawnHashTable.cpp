@@ -0,0 +1,32 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#include "pawnHashTable.h"
+#include "hashTable.h"
+#include <algorithm>
+
+PawnHashTable::PawnHashTable(size_t entryCount)
+{
+    size_t count = hashTableSize(entryCount);
+    entries.assign(count, Entry());
+    mask = count - 1;
+}
+
+void PawnHashTable::clear()
+{
+    std::fill(entries.begin(), entries.end(), Entry());
+}
+
+bool PawnHashTable::probe(uint64_t key, float &score) const
+{
+    const Entry &slot = entries[key & mask];
+    if (slot.key != key)
+        return false;
+    score = slot.score;
+    return true;
+}
+
+void PawnHashTable::store(uint64_t key, float score)
+{
+    Entry &slot = entries[key & mask];
+    slot.key = key;
+    slot.score = score;
+}
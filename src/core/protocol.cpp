@@ -0,0 +1,437 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#include "protocol.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "globals.h"
+#include "bench.h"
+#include "gameLogic.h"
+#include "notation.h"
+#include "log.h"
+
+namespace
+{
+    std::string firstWord(const std::string &line)
+    {
+        std::istringstream tokens(line);
+        std::string word;
+        tokens >> word;
+        return word;
+    }
+
+    bool parseBool(const std::string &value)
+    {
+        return value == "true" || value == "on" || value == "1";
+    }
+}
+
+void Protocol::run(std::istream &input)
+{
+    // the search and the rules log a line for nearly every move, which
+    // would break the protocol, warnings and errors still reach stderr
+    Log::Level previousLevel = Log::level();
+    Log::setLevel(Log::Level::Warning);
+    output = &std::cout;
+    chessboard.resetBoard();
+
+    // stop is acted on here rather than queued, and remembers which go it
+    // came after so go can tell whether it was stopped before it started
+    std::thread reader([this, &input]()
+                       {
+        std::string line;
+        while (std::getline(input, line))
+        {
+            std::string command = firstWord(line);
+            if (command == "stop")
+            {
+                stopSearches();
+                continue;
+            }
+            if (command == "isready")
+            {
+                send("readyok");
+                continue;
+            }
+            if (command == "go")
+                ++goQueued;
+            else if (command == "quit")
+                stopSearches();
+            push(line);
+            if (command == "quit")
+                return;
+        }
+        // the end of the input is a quit, a running search included
+        stopSearches();
+        push("quit"); });
+
+    while (true)
+    {
+        std::string line;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueReady.wait(lock, [this]()
+                            { return !queue.empty(); });
+            line = queue.front();
+            queue.pop_front();
+        }
+        if (!handle(line))
+            break;
+    }
+
+    reader.join();
+    ai.setIterationCallback(nullptr);
+    Log::setLevel(previousLevel);
+    output = nullptr;
+}
+
+std::string Protocol::squareName(Types::Coord square)
+{
+    std::string name(1, static_cast<char>('a' + square.x));
+    name += std::to_string(Chessboard::rows - square.y);
+    return name;
+}
+
+bool Protocol::parseSquare(const std::string &text, Types::Coord &square)
+{
+    if (text.size() < 2 || text.size() > 3 || text[0] < 'a' ||
+        text[0] >= 'a' + Chessboard::cols)
+        return false;
+    if (!std::all_of(text.begin() + 1, text.end(), ::isdigit))
+        return false;
+
+    int rank = std::stoi(text.substr(1));
+    if (rank < 1 || rank > Chessboard::rows)
+        return false;
+    square = {text[0] - 'a', Chessboard::rows - rank};
+    return true;
+}
+
+std::string Protocol::moveName(const Types::Turn &move)
+{
+    return squareName(move.initialSquare) + squareName(move.finalSquare);
+}
+
+bool Protocol::handle(const std::string &line)
+{
+    std::istringstream tokens(line);
+    std::string command;
+    if (!(tokens >> command))
+        return true;
+
+    if (command == "uci")
+        identify();
+    else if (command == "ucinewgame")
+    {
+        ai.clearTranspositionTable();
+        ai.clearEvaluationCaches();
+    }
+    else if (command == "setoption")
+        setOption(tokens);
+    else if (command == "position")
+        setPosition(tokens);
+    else if (command == "go")
+        go(tokens);
+    else if (command == "bench")
+    {
+        int depth = Bench::DEFAULT_DEPTH;
+        tokens >> depth;
+        Bench::Result result = Bench::run(std::clamp(depth, 1, AI::MAX_PLY - 1));
+        send("info string bench nodes " + std::to_string(result.nodes) + " time " +
+             std::to_string(static_cast<long long>(result.seconds * 1000.0)) + " nps " +
+             std::to_string(static_cast<long long>(result.nodesPerSecond)));
+    }
+    else if (command == "quit")
+        return false;
+    else
+        send("info string unknown command " + command);
+    return true;
+}
+
+void Protocol::identify()
+{
+    auto check = [](bool value)
+    { return std::string(value ? "true" : "false"); };
+
+    send(std::string("id name ") + ENGINE_NAME);
+    send(std::string("id author ") + ENGINE_AUTHOR);
+    send("option name Hash type spin default " + std::to_string(options.hashSizeMb) +
+         " min 1 max 4096");
+    send("option name EvalCache type spin default " + std::to_string(options.evalCacheSizeMb) +
+         " min 0 max 1024");
+    send("option name NullMove type check default " + check(options.nullMovePruning));
+    send("option name LMR type check default " + check(options.lateMoveReductions));
+    send("option name OwnBook type check default " + check(options.useOpeningBook));
+    send("option name Tablebases type check default " + check(options.useTablebases));
+    send("option name NNUE type check default " + check(options.useNnue));
+    send("option name Deterministic type check default " + check(options.deterministic));
+    send("uciok");
+}
+
+// setoption name <name> value <value>
+void Protocol::setOption(std::istringstream &tokens)
+{
+    std::string keyword, name, value;
+    tokens >> keyword >> name >> keyword >> value;
+    try
+    {
+        if (name == "Hash")
+            options.hashSizeMb = std::clamp(std::stoi(value), 1, 4096);
+        else if (name == "EvalCache")
+            options.evalCacheSizeMb = std::clamp(std::stoi(value), 0, 1024);
+        else if (name == "NullMove")
+            options.nullMovePruning = parseBool(value);
+        else if (name == "LMR")
+            options.lateMoveReductions = parseBool(value);
+        else if (name == "OwnBook")
+            options.useOpeningBook = parseBool(value);
+        else if (name == "Tablebases")
+            options.useTablebases = parseBool(value);
+        else if (name == "NNUE")
+            options.useNnue = parseBool(value);
+        else if (name == "Deterministic")
+            options.deterministic = parseBool(value);
+        else
+        {
+            send("info string unknown option " + name);
+            return;
+        }
+    }
+    catch (const std::exception &)
+    {
+        send("info string invalid value for " + name);
+        return;
+    }
+    ai.setOptions(options);
+}
+
+// the board is set up straight away, moves are checked against the legal
+// moves of the rule set and the first one that does not fit ends the list
+void Protocol::setPosition(std::istringstream &tokens)
+{
+    std::string array;
+    tokens >> array;
+    player = 'w';
+    turn = 1;
+    alt = false;
+
+    std::string token;
+    if (array == "fen")
+    {
+        // the fields of the notation run up to the move list
+        std::string text;
+        while (tokens >> token && token != "moves")
+            text += (text.empty() ? "" : " ") + token;
+        Notation::Position position;
+        if (!Notation::parse(text, position))
+        {
+            send("info string invalid position " + text);
+            return;
+        }
+        chessboard.setBoard(position.board);
+        player = position.sideToMove;
+        turn = position.turn;
+        alt = position.alt;
+    }
+    else
+    {
+        if (array == "startpos" || array == "masculine")
+            chessboard.setMasculineBoard();
+        else if (array == "feminine")
+            chessboard.setFeminineBoard();
+        else if (array == "third")
+            chessboard.setThirdBoard();
+        else
+        {
+            send("info string unknown starting array " + array);
+            return;
+        }
+        tokens >> token;
+    }
+
+    if (token == "alt")
+    {
+        alt = true;
+        tokens >> token;
+    }
+    if (token != "moves")
+        return;
+
+    GameLogic gameLogic;
+    while (tokens >> token)
+    {
+        Types::Coord from, to;
+        std::vector<Types::Turn> legalMoves = ai.generateAllLegalMoves(player, turn, alt);
+        auto move = legalMoves.end();
+        if (token.size() >= 4)
+        {
+            for (size_t split = 2; split <= 3 && move == legalMoves.end(); ++split)
+            {
+                if (!parseSquare(token.substr(0, split), from) ||
+                    !parseSquare(token.substr(split), to))
+                    continue;
+                move = std::find_if(legalMoves.begin(), legalMoves.end(),
+                                    [&](const Types::Turn &legal)
+                                    { return legal.initialSquare == from && legal.finalSquare == to; });
+            }
+        }
+        if (move == legalMoves.end())
+        {
+            send("info string illegal move " + token);
+            return;
+        }
+
+        gameLogic.playMove(*move);
+        player = (player == 'w') ? 'b' : 'w';
+        ++turn;
+    }
+}
+
+void Protocol::go(std::istringstream &tokens)
+{
+    Types::SearchOptions searchOptions = options;
+    int depth = AI::MAX_PLY - 1;
+    bool infinite = false;
+    long long clock[2] = {0, 0}; // white, black
+    long long increment[2] = {0, 0};
+
+    std::string token;
+    try
+    {
+        while (tokens >> token)
+        {
+            if (token == "infinite")
+            {
+                infinite = true;
+                continue;
+            }
+            std::string value;
+            if (!(tokens >> value))
+                break;
+            if (token == "depth")
+                depth = std::clamp(std::stoi(value), 1, AI::MAX_PLY - 1);
+            else if (token == "nodes")
+                searchOptions.nodeLimit = std::stoll(value);
+            else if (token == "movetime")
+                searchOptions.timeLimitMs = std::max(1LL, std::stoll(value));
+            else if (token == "wtime")
+                clock[0] = std::stoll(value);
+            else if (token == "btime")
+                clock[1] = std::stoll(value);
+            else if (token == "winc")
+                increment[0] = std::stoll(value);
+            else if (token == "binc")
+                increment[1] = std::stoll(value);
+        }
+    }
+    catch (const std::exception &)
+    {
+        send("info string invalid value for " + token);
+    }
+
+    // a thirtieth of the clock plus half the increment when playing on time
+    int side = (player == 'w') ? 0 : 1;
+    if (searchOptions.timeLimitMs == 0 && clock[side] > 0)
+        searchOptions.timeLimitMs = std::max(1LL, clock[side] / 30 + increment[side] / 2);
+    ai.setOptions(searchOptions);
+
+    // cleared first and checked after, so a stop read in between still holds
+    int id = ++goStarted;
+    ai.clearStop();
+    if (stoppedThrough >= id)
+        ai.stop();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    Types::IterationStats last;
+    std::vector<Types::Turn> lastLine;
+    auto report = [&](const Types::IterationStats &iteration,
+                      const std::vector<Types::Turn> &line)
+    {
+        last = iteration;
+        lastLine = line;
+        const Types::SearchStats &stats = ai.getSearchStats();
+        long long nodes = stats.nodes + stats.quiescenceNodes;
+        long long milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     std::chrono::high_resolution_clock::now() - start)
+                                     .count();
+        float score = (player == 'w') ? iteration.score : -iteration.score;
+
+        std::ostringstream info;
+        info << "info depth " << iteration.depth << " seldepth " << stats.selectiveDepth
+             << " score cp " << static_cast<long long>(std::lround(score * 100.0f))
+             << " nodes " << nodes << " nps " << nodes * 1000 / std::max(1LL, milliseconds)
+             << " time " << milliseconds << " pv";
+        for (const auto &move : line)
+            info << " " << moveName(move);
+        send(info.str());
+    };
+    ai.setIterationCallback(report);
+
+    std::string reply;
+    try
+    {
+        Types::Turn best = ai.minMax(player, turn, alt, depth,
+                                     -std::numeric_limits<float>::infinity(),
+                                     std::numeric_limits<float>::infinity());
+        if (ai.getSearchStats().bookMove)
+            send("info string book move");
+
+        // the move played is a random pick among equal scores, repeat the
+        // last iteration with its line so the final pv starts with it
+        const std::vector<Types::Turn> line = ai.getPrincipalVariation();
+        if (!lastLine.empty() && !line.empty() &&
+            moveName(line.front()) != moveName(lastLine.front()))
+            report(last, line);
+
+        reply = "bestmove " + moveName(best);
+        if (line.size() >= 2)
+            reply += " ponder " + moveName(line[1]);
+    }
+    catch (const std::runtime_error &)
+    {
+        // checkmate or stalemate on the board
+        reply = "bestmove (none)";
+    }
+
+    // go infinite answers only once told to stop
+    if (infinite)
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        queueReady.wait(lock, [this, id]()
+                        { return stoppedThrough >= id; });
+    }
+    send(reply);
+
+    ai.setIterationCallback(nullptr);
+    ai.setOptions(options);
+}
+
+void Protocol::stopSearches()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stoppedThrough = goQueued.load();
+    }
+    ai.stop();
+    queueReady.notify_all();
+}
+
+void Protocol::send(const std::string &line)
+{
+    std::lock_guard<std::mutex> lock(outputMutex);
+    *output << line << std::endl;
+}
+
+void Protocol::push(const std::string &line)
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.push_back(line);
+    }
+    queueReady.notify_one();
+}
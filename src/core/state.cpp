@@ -19,6 +19,7 @@ bool State::aiActive = false;
 bool State::aiMoveQueued = false;
 bool State::animationActive = false;
 bool State::renderNeeded = true;
+bool State::showSearchStats = false;
 sf::Clock State::aiVsAiClock;
 sf::Clock State::gameStartClock;
 int State::currentGameId = -1;
@@ -27,11 +28,6 @@ int State::currentGameId = -1;
 sf::Clock State::deltaClock;
 float State::deltaTime = State::deltaClock.restart().asSeconds();
 
-// Images
-std::map<std::string, sf::Sprite> State::images;
-sf::Sprite State::backgroundSprite;
-sf::Texture State::backgroundTexture;
-
 // Captured pieces
 std::vector<std::string> State::whitePiecesCaptured;
 std::vector<std::string> State::blackPiecesCaptured;
@@ -47,12 +43,8 @@ Types::Coord State::selectedSquare = {-1, -1};
 // this needs to be a char array to avoid global string issues
 Types::Piece State::selectedPiece;
 
-// Colors for the chess board and piece highlighting
-sf::Color State::colour1 = sf::Color(0xE5E5E5ff);
-sf::Color State::colour2 = sf::Color(0x26403Cff);
-sf::Color State::colourSelected = sf::Color(0x6290c8ff);
-sf::Color State::colourPrevMove = sf::Color(0x6290c855);
-sf::Color State::colourMove = sf::Color(0xFBFF1255);
+// images and colours are defined in render.cpp, they need sfml-graphics
+// which the engine library and the command line tools do not link
 
 // Camera/zoom system
 State::ZoomLevel State::currentZoomLevel = State::ZoomLevel::ZoomedOut;
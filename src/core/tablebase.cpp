@@ -0,0 +1,343 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#include "tablebase.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include "chessboard.h"
+
+// full piece code for each type a table can hold, empty for anything else
+static std::string pieceCode(char color, char type)
+{
+    static const std::map<char, std::string> codes = {
+        {'K', "Ka"}, {'R', "Rk"}, {'T', "Ta"}, {'M', "Mo"}, {'C', "Ca"},
+        {'G', "Gi"}, {'E', "El"}, {'W', "We"}, {'V', "Vi"}, {'A', "Ad"}};
+    auto found = codes.find(type);
+    if (found == codes.end())
+        return "";
+    return std::string(1, color) + found->second;
+}
+
+std::string Tablebase::Material::name() const
+{
+    return "K" + white + "vK" + black;
+}
+
+bool Tablebase::Material::parse(const std::string &name)
+{
+    size_t split = name.find("vK");
+    if (name.size() < 4 || name[0] != 'K' || split == std::string::npos)
+        return false;
+
+    white = name.substr(1, split - 1);
+    black = name.substr(split + 2);
+    for (const std::string *side : {&white, &black})
+    {
+        for (char type : *side)
+        {
+            if (type == 'K' || pieceCode('w', type).empty())
+                return false;
+        }
+    }
+    std::sort(white.begin(), white.end());
+    std::sort(black.begin(), black.end());
+    return pieceCount() <= MAX_PIECES;
+}
+
+namespace
+{
+    // every placement of the two Khans apart from each other. The
+    // fortresses only sit on one side of the board, so its mirror images
+    // don't play alike and every placement has its own entry
+    struct KhanPairs
+    {
+        std::vector<std::pair<int, int>> squares;
+        int index[Tablebase::SQUARES][Tablebase::SQUARES];
+
+        KhanPairs()
+        {
+            for (auto &row : index)
+                std::fill(std::begin(row), std::end(row), -1);
+
+            for (int white = 0; white < Tablebase::SQUARES; ++white)
+            {
+                int whiteCol = white % Chessboard::cols;
+                int whiteRow = white / Chessboard::cols;
+                for (int black = 0; black < Tablebase::SQUARES; ++black)
+                {
+                    int blackCol = black % Chessboard::cols;
+                    int blackRow = black / Chessboard::cols;
+                    if (std::abs(blackCol - whiteCol) <= 1 && std::abs(blackRow - whiteRow) <= 1)
+                        continue;
+
+                    index[white][black] = static_cast<int>(squares.size());
+                    squares.emplace_back(white, black);
+                }
+            }
+        }
+    };
+
+    const KhanPairs &khanPairs()
+    {
+        static const KhanPairs pairs;
+        return pairs;
+    }
+}
+
+uint64_t Tablebase::tableSize(int pieceCount)
+{
+    uint64_t size = 2 * khanPairs().squares.size();
+    for (int i = 2; i < pieceCount; ++i)
+        size *= SQUARES - i;
+    return size;
+}
+
+uint64_t Tablebase::index(int pieceCount, const int *squares, char player)
+{
+    const KhanPairs &pairs = khanPairs();
+    int pair = pairs.index[squares[0]][squares[1]];
+    if (pair < 0)
+        return NO_INDEX;
+
+    uint64_t result = (player == 'w') ? 0 : pairs.squares.size();
+    result += static_cast<uint64_t>(pair);
+    for (int i = 2; i < pieceCount; ++i)
+    {
+        // counted over the squares the pieces before it leave free
+        int rank = squares[i];
+        for (int j = 0; j < i; ++j)
+        {
+            if (squares[j] == squares[i])
+                return NO_INDEX;
+            if (squares[j] < squares[i])
+                --rank;
+        }
+        result = result * static_cast<uint64_t>(SQUARES - i) + static_cast<uint64_t>(rank);
+    }
+    return result;
+}
+
+void Tablebase::decode(uint64_t index, int pieceCount, int *squares, char &player)
+{
+    int ranks[MAX_PIECES];
+    for (int i = pieceCount - 1; i >= 2; --i)
+    {
+        ranks[i] = static_cast<int>(index % static_cast<uint64_t>(SQUARES - i));
+        index /= static_cast<uint64_t>(SQUARES - i);
+    }
+
+    const KhanPairs &pairs = khanPairs();
+    const auto &khans = pairs.squares[index % pairs.squares.size()];
+    squares[0] = khans.first;
+    squares[1] = khans.second;
+    player = (index < pairs.squares.size()) ? 'w' : 'b';
+
+    for (int i = 2; i < pieceCount; ++i)
+    {
+        // move up past the taken squares until none more lie below
+        int square = ranks[i];
+        while (true)
+        {
+            int taken = 0;
+            for (int j = 0; j < i; ++j)
+            {
+                if (squares[j] <= square)
+                    ++taken;
+            }
+            if (ranks[i] + taken == square)
+                break;
+            square = ranks[i] + taken;
+        }
+        squares[i] = square;
+    }
+}
+
+std::vector<Types::Piece> Tablebase::tablePieces(const Material &material)
+{
+    std::vector<Types::Piece> pieces = {Types::Piece("wKa"), Types::Piece("bKa")};
+    for (char type : material.white)
+        pieces.emplace_back(pieceCode('w', type));
+    for (char type : material.black)
+        pieces.emplace_back(pieceCode('b', type));
+    return pieces;
+}
+
+std::string Tablebase::fileName(const Material &material, bool alt)
+{
+    return material.name() + (alt ? ".alt" : "") + ".ttb";
+}
+
+bool Tablebase::write(const std::string &path, const Material &material, bool alt,
+                      const std::vector<uint8_t> &values)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open tablebase for writing: " << path << std::endl;
+        return false;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+    std::strncpy(header.material, material.name().c_str(), sizeof(header.material) - 1);
+    header.alt = alt ? 1 : 0;
+    header.pieceCount = static_cast<uint8_t>(material.pieceCount());
+    header.count = values.size();
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(values.data()),
+               static_cast<std::streamsize>(values.size()));
+    return file.good();
+}
+
+Tablebase::ProbeResult Tablebase::decodeValue(uint8_t value)
+{
+    ProbeResult result;
+    if (value == DRAW || value == INVALID)
+        return result;
+
+    result.distance = value - 1;
+    result.outcome = (result.distance % 2 == 1) ? Outcome::Win : Outcome::Loss;
+    return result;
+}
+
+bool Tablebase::materialOf(const Types::Board &board, Material &material, int pieceLimit)
+{
+    material = Material();
+    int pieces = 0;
+    int khans = 0;
+    for (int row = 0; row < Chessboard::rows; ++row)
+    {
+        for (int col = 0; col < Chessboard::cols; ++col)
+        {
+            const Types::Piece &piece = board.board[row][col];
+            if (piece.color() != 'w' && piece.color() != 'b')
+                continue;
+            if (++pieces > pieceLimit || piece.piece() == 'p')
+                return false;
+
+            if (piece.piece() == 'K')
+            {
+                // princes and adventitious Khans are not in the tables
+                if (piece.variant() != 'a')
+                    return false;
+                ++khans;
+            }
+            else
+            {
+                (piece.color() == 'w' ? material.white : material.black) += piece.piece();
+            }
+        }
+    }
+    std::sort(material.white.begin(), material.white.end());
+    std::sort(material.black.begin(), material.black.end());
+    return khans == 2;
+}
+
+int Tablebase::load(const std::string &directory)
+{
+    tables.clear();
+    largestTable = 0;
+
+    std::error_code error;
+    if (!std::filesystem::is_directory(directory, error))
+        return 0;
+
+    for (const auto &entry : std::filesystem::directory_iterator(directory, error))
+    {
+        if (!entry.is_regular_file() || entry.path().extension() != ".ttb")
+            continue;
+
+        auto table = std::make_unique<Table>();
+        if (!table->file.open(entry.path().string()))
+            continue;
+
+        const Header *header = static_cast<const Header *>(table->file.data());
+        Material material;
+        if (table->file.size() < sizeof(Header) ||
+            std::memcmp(header->magic, MAGIC, sizeof(header->magic)) != 0 ||
+            !material.parse(std::string(header->material, strnlen(header->material, sizeof(header->material)))) ||
+            header->count != tableSize(material.pieceCount()) ||
+            table->file.size() != sizeof(Header) + header->count)
+        {
+            std::cerr << "Invalid tablebase: " << entry.path().string() << std::endl;
+            continue;
+        }
+
+        table->values = static_cast<const uint8_t *>(table->file.data()) + sizeof(Header);
+        largestTable = std::max(largestTable, material.pieceCount());
+        tables[fileName(material, header->alt != 0)] = std::move(table);
+    }
+
+    return static_cast<int>(tables.size());
+}
+
+bool Tablebase::probe(const Types::Board &board, char player, bool alt,
+                      ProbeResult &result, int pieceLimit) const
+{
+    Material material;
+    if (tables.empty() ||
+        !materialOf(board, material, std::min(pieceLimit, largestTable)))
+        return false;
+
+    // the board is the same turned half way round, fortresses included, so
+    // a table for the colours swapped covers the position with the board
+    // rotated
+    bool rotated = false;
+    auto table = tables.find(fileName(material, alt));
+    if (table == tables.end())
+    {
+        table = tables.find(fileName(material.swapped(), alt));
+        if (table == tables.end())
+            return false;
+        rotated = true;
+        material = material.swapped();
+    }
+
+    std::vector<Types::Piece> pieces = tablePieces(material);
+    int squares[MAX_PIECES];
+    bool used[MAX_PIECES] = {};
+    for (int row = 0; row < Chessboard::rows; ++row)
+    {
+        for (int col = 0; col < Chessboard::cols; ++col)
+        {
+            Types::Piece piece = board.board[row][col];
+            if (piece.color() != 'w' && piece.color() != 'b')
+                continue;
+
+            int square = row * Chessboard::cols + col;
+            if (rotated)
+            {
+                square = (SQUARES - 1) - square;
+                piece.code[0] = (piece.color() == 'w') ? 'b' : 'w';
+            }
+
+            // duplicate pieces take the first free slot of their kind, the
+            // table holds every ordering of them
+            for (size_t slot = 0; slot < pieces.size(); ++slot)
+            {
+                if (!used[slot] && pieces[slot].color() == piece.color() &&
+                    pieces[slot].piece() == piece.piece())
+                {
+                    used[slot] = true;
+                    squares[slot] = square;
+                    break;
+                }
+            }
+        }
+    }
+
+    char tablePlayer = player;
+    if (rotated)
+        tablePlayer = (player == 'w') ? 'b' : 'w';
+
+    uint64_t position = index(material.pieceCount(), squares, tablePlayer);
+    if (position == NO_INDEX)
+        return false;
+    uint8_t value = table->second->values[position];
+    if (value == INVALID)
+        return false;
+    result = decodeValue(value);
+    return true;
+}
@@ -0,0 +1,226 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#include "trainingData.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include "chessboard.h"
+
+namespace
+{
+    // every piece code the rules can put on the board, without the colour.
+    // A packed piece is its index here with the top bit set for black
+    constexpr const char *PIECE_CODES[] = {
+        "Rk", "Mo", "Ta", "Gi", "Vi", "Ka", "Ad", "El", "Ca", "We", "K0", "K1",
+        "pR", "pM", "pT", "pG", "pV", "pK", "pA", "pE", "pC", "pW", "p0", "p1", "p2", "px"};
+    constexpr int PIECE_CODE_COUNT = sizeof(PIECE_CODES) / sizeof(PIECE_CODES[0]);
+    constexpr uint8_t BLACK_BIT = 0x80;
+
+    int codeIndex(const Types::Piece &piece)
+    {
+        for (int index = 0; index < PIECE_CODE_COUNT; ++index)
+        {
+            if (piece.code[1] == PIECE_CODES[index][0] && piece.code[2] == PIECE_CODES[index][1])
+                return index;
+        }
+        return -1;
+    }
+}
+
+bool TrainingData::pack(const Types::Board &board, char sideToMove, Record &record)
+{
+    std::memset(&record, 0, sizeof(record));
+    record.sideToMove = sideToMove;
+
+    int pieceCount = 0;
+    for (int square = 0; square < Chessboard::rows * Chessboard::cols; ++square)
+    {
+        const Types::Piece &piece = board.board[square / Chessboard::cols][square % Chessboard::cols];
+        char color = piece.color();
+        if (color != 'w' && color != 'b')
+            continue;
+
+        int index = codeIndex(piece);
+        if (index < 0 || pieceCount == MAX_PIECES)
+            return false;
+        record.occupancy[square / 8] |= static_cast<uint8_t>(1 << (square % 8));
+        record.pieces[pieceCount++] = static_cast<uint8_t>(index | (color == 'b' ? BLACK_BIT : 0));
+    }
+    return true;
+}
+
+Types::Board TrainingData::unpack(const Record &record)
+{
+    Types::Board board;
+    int pieceCount = 0;
+    for (int square = 0; square < Chessboard::rows * Chessboard::cols; ++square)
+    {
+        if (!(record.occupancy[square / 8] & (1 << (square % 8))))
+            continue;
+
+        uint8_t packed = record.pieces[pieceCount++];
+        const char *code = PIECE_CODES[std::min<int>(packed & ~BLACK_BIT, PIECE_CODE_COUNT - 1)];
+        char piece[4] = {(packed & BLACK_BIT) ? 'b' : 'w', code[0], code[1], '\0'};
+        board.board[square / Chessboard::cols][square % Chessboard::cols] = Types::Piece(piece);
+    }
+    return board;
+}
+
+// FNV-1a over the raw record bytes
+uint32_t TrainingData::checksum(const Record *records, size_t count)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(records);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < count * sizeof(Record); ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool TrainingData::Writer::open(const std::string &path)
+{
+    close();
+    std::lock_guard<std::mutex> lock(mutex);
+
+    bool append = false;
+    std::error_code error;
+    if (std::filesystem::exists(path, error) && std::filesystem::file_size(path, error) > 0)
+    {
+        size_t validBytes = 0;
+        {
+            Reader reader;
+            if (!reader.open(path))
+                return false;
+            validBytes = reader.validBytes();
+        }
+        std::filesystem::resize_file(path, validBytes, error);
+        if (error)
+        {
+            std::cerr << "Failed to repair training data: " << path << std::endl;
+            return false;
+        }
+        append = true;
+    }
+
+    file.open(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open training data for writing: " << path << std::endl;
+        return false;
+    }
+    if (!append)
+    {
+        Header header{};
+        std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    }
+    recordsWritten = 0;
+    return file.good();
+}
+
+void TrainingData::Writer::write(const std::vector<Record> &records)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.is_open())
+        return;
+
+    pending.insert(pending.end(), records.begin(), records.end());
+    size_t offset = 0;
+    while (pending.size() - offset >= CHUNK_RECORDS)
+    {
+        writeChunk(pending.data() + offset, CHUNK_RECORDS);
+        offset += CHUNK_RECORDS;
+    }
+    pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(offset));
+}
+
+void TrainingData::Writer::close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.is_open())
+        return;
+    if (!pending.empty())
+        writeChunk(pending.data(), pending.size());
+    pending.clear();
+    file.close();
+}
+
+void TrainingData::Writer::writeChunk(const Record *records, size_t count)
+{
+    ChunkHeader header{};
+    std::memcpy(header.magic, CHUNK_MAGIC, sizeof(header.magic));
+    header.count = static_cast<uint32_t>(count);
+    header.checksum = checksum(records, count);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(records),
+               static_cast<std::streamsize>(count * sizeof(Record)));
+    // whole chunks reach the disk as they are finished
+    file.flush();
+    recordsWritten += count;
+}
+
+bool TrainingData::Reader::open(const std::string &path)
+{
+    chunks.clear();
+    recordCount = 0;
+    validLength = 0;
+    if (!file.open(path))
+        return false;
+
+    const char *data = static_cast<const char *>(file.data());
+    const Header *header = reinterpret_cast<const Header *>(data);
+    if (file.size() < sizeof(Header) ||
+        std::memcmp(header->magic, MAGIC, sizeof(header->magic)) != 0)
+    {
+        std::cerr << "Invalid training data: " << path << std::endl;
+        file.close();
+        return false;
+    }
+
+    // stop at the first chunk that is cut short or does not add up, the
+    // writer appends after the last intact one
+    size_t offset = sizeof(Header);
+    while (offset + sizeof(ChunkHeader) <= file.size())
+    {
+        const ChunkHeader *chunk = reinterpret_cast<const ChunkHeader *>(data + offset);
+        size_t end = offset + sizeof(ChunkHeader) + chunk->count * sizeof(Record);
+        const Record *records = reinterpret_cast<const Record *>(data + offset + sizeof(ChunkHeader));
+        if (std::memcmp(chunk->magic, CHUNK_MAGIC, sizeof(chunk->magic)) != 0 ||
+            chunk->count == 0 || chunk->count > CHUNK_RECORDS || end > file.size() ||
+            checksum(records, chunk->count) != chunk->checksum)
+        {
+            std::cerr << "Training data damaged after " << recordCount
+                      << " records: " << path << std::endl;
+            break;
+        }
+        chunks.push_back({records, recordCount, chunk->count});
+        recordCount += chunk->count;
+        offset = end;
+    }
+    validLength = offset;
+    return true;
+}
+
+const TrainingData::Record &TrainingData::Reader::operator[](size_t index) const
+{
+    auto chunk = std::upper_bound(chunks.begin(), chunks.end(), index,
+                                  [](size_t value, const Chunk &entry)
+                                  { return value < entry.firstIndex; });
+    --chunk;
+    return chunk->records[index - chunk->firstIndex];
+}
+
+std::vector<TrainingData::Record> TrainingData::Reader::sample(size_t count, std::mt19937 &rng) const
+{
+    std::vector<Record> picked;
+    if (recordCount == 0)
+        return picked;
+
+    std::uniform_int_distribution<size_t> pick(0, recordCount - 1);
+    picked.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        picked.push_back((*this)[pick(rng)]);
+    return picked;
+}
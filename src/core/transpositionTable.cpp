@@ -0,0 +1,62 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#include "transpositionTable.h"
+#include "hashTable.h"
+#include <algorithm>
+
+TranspositionTable::TranspositionTable(size_t sizeMb)
+{
+    resize(sizeMb);
+}
+
+void TranspositionTable::resize(size_t sizeMb)
+{
+    size_t count = hashTableSize(sizeMb * 1024 * 1024 / sizeof(Entry));
+    entries.assign(count, Entry());
+    mask = count - 1;
+}
+
+void TranspositionTable::clear()
+{
+    std::fill(entries.begin(), entries.end(), Entry());
+    generation = 0;
+}
+
+bool TranspositionTable::probe(uint64_t key, Entry &entry) const
+{
+    const Entry &slot = entries[key & mask];
+    if (slot.bound == Bound::None || slot.key != key)
+        return false;
+    entry = slot;
+    return true;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, float score,
+                               Bound bound, const Types::Turn *bestMove)
+{
+    Entry &slot = entries[key & mask];
+
+    // keep a deeper result for the same search unless it's this position
+    if (slot.bound != Bound::None && slot.generation == generation &&
+        slot.key != key && slot.depth > depth)
+        return;
+
+    // a shallower result for the same position keeps the old best move
+    bool keepMove = slot.key == key && slot.hasMove() && bestMove == nullptr;
+
+    slot.key = key;
+    slot.score = score;
+    slot.depth = static_cast<int16_t>(depth);
+    slot.bound = bound;
+    slot.generation = generation;
+    if (bestMove != nullptr)
+    {
+        slot.fromX = static_cast<int8_t>(bestMove->initialSquare.x);
+        slot.fromY = static_cast<int8_t>(bestMove->initialSquare.y);
+        slot.toX = static_cast<int8_t>(bestMove->finalSquare.x);
+        slot.toY = static_cast<int8_t>(bestMove->finalSquare.y);
+    }
+    else if (!keepMove)
+    {
+        slot.fromX = slot.fromY = slot.toX = slot.toY = 0;
+    }
+}
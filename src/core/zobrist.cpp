@@ -0,0 +1,36 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#include "zobrist.h"
+#include "chessboard.h"
+
+// splitmix64 finaliser, spreads the packed square and piece code over all bits
+static uint64_t mix(uint64_t value)
+{
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+uint64_t Zobrist::pieceKey(int row, int col, const Types::Piece &piece)
+{
+    uint64_t square = static_cast<uint64_t>(row * Chessboard::cols + col);
+    uint64_t code = (static_cast<uint64_t>(static_cast<unsigned char>(piece.color())) << 16) |
+                    (static_cast<uint64_t>(static_cast<unsigned char>(piece.piece())) << 8) |
+                    static_cast<uint64_t>(static_cast<unsigned char>(piece.variant()));
+    return mix((square << 24) | code);
+}
+
+uint64_t Zobrist::hash(const Types::Board &board, char player, bool alt)
+{
+    uint64_t key = 0;
+    for (int row = 0; row < Chessboard::rows; ++row)
+    {
+        for (int col = 0; col < Chessboard::cols; ++col)
+        {
+            const Types::Piece &piece = board.board[row][col];
+            if (piece.color() != '-')
+                key ^= pieceKey(row, col, piece);
+        }
+    }
+    return key ^ stateKey(player, alt);
+}
@@ -10,13 +10,207 @@
  * tables for evaluation. Players can play against the AI or another human player.
  *
  * SFML dependencies are included in the external folder and configured in CMakeLists.txt
+ *
+ * Search features can be switched from the command line for A/B testing:
+ *   --no-null-move                 disable null move pruning
+ *   --null-move-reduction <n>      extra plies removed from the null move search
+ *   --no-lmr                       disable late move reductions
+ *   --lmr-full-depth-moves <n>     moves searched at full depth before reducing
+ *   --lmr-base <x>                 reduction = base + log(depth) * log(move) / divisor
+ *   --lmr-divisor <x>
+ *   --hash <mb>                    transposition table size in megabytes
+ *   --eval-cache <mb>              evaluation cache size in megabytes, 0 disables it
+ *   --search-stats                 print search statistics to stderr as JSON lines
+ *   --debug-overlay                show search statistics in game (toggle with F3)
+ *   --deterministic                break ties by move order, fresh hash table per search
+ *   --seed <n>                     seed for the random choice between tied moves
+ *   --book <path>                  opening book to load (default games/book.bin)
+ *   --no-book                      always search, even in book positions
+ *   --tablebases <dir>             endgame tablebase directory (default tablebases)
+ *   --tablebase-pieces <n>         largest endings to look up, 0 disables lookups
+ *   --eval-params <path>           evaluation weights to load (default eval.params)
+ *   --nnue <path>                  NNUE network to evaluate with (default eval.nnue)
+ *   --no-nnue                      use the hand written evaluation even with a network
+ *   --log-level <level>            debug, info, warning or error (default info)
+ *
+ *   --bench                        search the bench suite, print the node signature and exit
+ *   --trace <path>                 write the trace zones to a Chrome trace file on exit
+ *                                  (needs a build configured with -DTAMERLANE_TRACING=ON)
+ *
+ * With --protocol no window is opened, the engine is driven over stdin and stdout
+ * by a UCI-like text protocol instead, see protocol.h
  */
 
+#include <iostream>
+#include <stdexcept>
+#include <string>
 #include "game.h"
+#include "globals.h"
+#include "bench.h"
+#include "evaluation.h"
+#include "nnue.h"
+#include "log.h"
+#include "protocol.h"
+#include "trace.h"
+
+// returns false when the arguments could not be parsed
+static bool parseArguments(int argc, char *argv[], Types::SearchOptions &options,
+                           std::string &bookPath, std::string &tablebaseDirectory,
+                           std::string &weightsPath, std::string &networkPath,
+                           bool &protocolMode, bool &benchMode,
+                           std::string &tracePath)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        try
+        {
+            if (arg == "--no-null-move")
+                options.nullMovePruning = false;
+            else if (arg == "--no-lmr")
+                options.lateMoveReductions = false;
+            else if (arg == "--null-move-reduction" && hasValue)
+                options.nullMoveReduction = std::stoi(argv[++i]);
+            else if (arg == "--lmr-full-depth-moves" && hasValue)
+                options.lateMoveFullDepthMoves = std::stoi(argv[++i]);
+            else if (arg == "--lmr-base" && hasValue)
+                options.lateMoveBase = std::stof(argv[++i]);
+            else if (arg == "--lmr-divisor" && hasValue)
+                options.lateMoveDivisor = std::stof(argv[++i]);
+            else if (arg == "--hash" && hasValue)
+                options.hashSizeMb = std::stoi(argv[++i]);
+            else if (arg == "--eval-cache" && hasValue)
+                options.evalCacheSizeMb = std::stoi(argv[++i]);
+            else if (arg == "--search-stats")
+                options.searchStatsJson = true;
+            else if (arg == "--debug-overlay")
+                State::showSearchStats = true;
+            else if (arg == "--deterministic")
+                options.deterministic = true;
+            else if (arg == "--seed" && hasValue)
+                options.seed = static_cast<unsigned int>(std::stoul(argv[++i]));
+            else if (arg == "--book" && hasValue)
+                bookPath = argv[++i];
+            else if (arg == "--no-book")
+                options.useOpeningBook = false;
+            else if (arg == "--tablebases" && hasValue)
+                tablebaseDirectory = argv[++i];
+            else if (arg == "--tablebase-pieces" && hasValue)
+            {
+                options.tablebasePieces = std::stoi(argv[++i]);
+                options.useTablebases = options.tablebasePieces > 0;
+            }
+            else if (arg == "--eval-params" && hasValue)
+                weightsPath = argv[++i];
+            else if (arg == "--nnue" && hasValue)
+                networkPath = argv[++i];
+            else if (arg == "--no-nnue")
+                options.useNnue = false;
+            else if (arg == "--log-level" && hasValue)
+            {
+                Log::Level level;
+                if (!Log::parseLevel(argv[++i], level))
+                    throw std::invalid_argument(arg);
+                Log::setLevel(level);
+            }
+            else if (arg == "--protocol")
+                protocolMode = true;
+            else if (arg == "--bench")
+                benchMode = true;
+            else if (arg == "--trace" && hasValue)
+                tracePath = argv[++i];
+            else
+            {
+                std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+                return false;
+            }
+        }
+        catch (const std::exception &)
+        {
+            std::cerr << "Invalid value for " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
 
-int main()
+int main(int argc, char *argv[])
 {
-    Game game;
-    game.run();
+    Types::SearchOptions options;
+    std::string bookPath = OpeningBook::DEFAULT_PATH;
+    std::string tablebaseDirectory = Tablebase::DEFAULT_DIRECTORY;
+    std::string weightsPath = Evaluation::DEFAULT_WEIGHTS_PATH;
+    std::string networkPath = Nnue::DEFAULT_PATH;
+    bool protocolMode = false;
+    bool benchMode = false;
+    std::string tracePath;
+    if (!parseArguments(argc, argv, options, bookPath, tablebaseDirectory,
+                        weightsPath, networkPath, protocolMode, benchMode, tracePath))
+    {
+        return 1;
+    }
+    if (!tracePath.empty() && !Trace::compiledIn())
+    {
+        std::cerr << "Built without tracing, --trace needs -DTAMERLANE_TRACING=ON" << std::endl;
+        return 1;
+    }
+    TRACE_THREAD("main");
+
+    // the bench ignores the files below so its signature stays put
+    if (benchMode)
+    {
+        Bench::run();
+        if (!tracePath.empty())
+            Trace::write(tracePath);
+        return 0;
+    }
+    ai.setOptions(options);
+
+    // tuned weights and the network are optional too, the built in
+    // evaluation is the fallback
+    bool weightsLoaded = Evaluation::loadWeights(weightsPath);
+    if (!weightsLoaded && weightsPath != Evaluation::DEFAULT_WEIGHTS_PATH)
+    {
+        std::cerr << "Could not load evaluation weights: " << weightsPath << std::endl;
+    }
+    bool networkLoaded = options.useNnue && Nnue::load(networkPath);
+    if (options.useNnue && !networkLoaded && networkPath != Nnue::DEFAULT_PATH)
+    {
+        std::cerr << "Could not load network: " << networkPath << std::endl;
+    }
+    if (weightsLoaded || networkLoaded)
+    {
+        // the starting board was summed up before either was loaded
+        chessboard.setBoard(chessboard.getBoardState());
+        ai.clearEvaluationCaches();
+    }
+
+    // the book is optional, without one every move is searched
+    if (options.useOpeningBook && !ai.loadOpeningBook(bookPath) &&
+        bookPath != OpeningBook::DEFAULT_PATH)
+    {
+        std::cerr << "Could not load opening book: " << bookPath << std::endl;
+    }
+    if (options.useTablebases && ai.loadTablebases(tablebaseDirectory) == 0 &&
+        tablebaseDirectory != Tablebase::DEFAULT_DIRECTORY)
+    {
+        std::cerr << "No tablebases found in: " << tablebaseDirectory << std::endl;
+    }
+
+    if (protocolMode)
+    {
+        Protocol protocol(ai);
+        protocol.run(std::cin);
+    }
+    else
+    {
+        Game game;
+        game.run();
+    }
+
+    if (!tracePath.empty())
+        Trace::write(tracePath);
     return 0;
 }
@@ -1,4 +1,5 @@
 #include "analysis.h"
+#include "trace.h"
 #include "render.h"
 #include "state.h"
 #include "utility.h"
@@ -7,6 +8,8 @@
 #include <SFML/Graphics.hpp>
 #include <sstream>
 #include <iomanip>
+#include <limits>
+#include <stdexcept>
 
 void Analysis::loadGames()
 {
@@ -136,6 +139,18 @@ void Analysis::handleEvent(sf::Event &event, sf::RenderWindow &window)
                 setBoardToMove(currentMoveIndex);
                 return;
             }
+
+            // Best line button
+            sf::RectangleShape bestLineButton = Utility::createButton(
+                sf::Vector2f(140, 30),
+                sf::Vector2f(window.getSize().x - 160, window.getSize().y - 330),
+                sf::Color::White);
+
+            if (Utility::isButtonClicked(bestLineButton, mousePosition))
+            {
+                calculateBestLine();
+                return;
+            }
         }
         
         // Handle keyboard navigation in analysis mode
@@ -642,6 +657,68 @@ void Analysis::drawCapturedPiecesPanel(sf::RenderWindow &window, const sf::Recta
     }
 }
 
+void Analysis::calculateBestLine()
+{
+    // Search the position on the board from the side to move, at the
+    // difficulty chosen in the menu
+    char player = (currentMoveIndex % 2 == 0) ? 'w' : 'b';
+    bestLine.clear();
+    bestLineMoveIndex = currentMoveIndex;
+    try
+    {
+        Types::Turn best = ai.minMax(player, currentMoveIndex + 1, State::alt,
+                                     State::aiDifficulty,
+                                     -std::numeric_limits<float>::infinity(),
+                                     std::numeric_limits<float>::infinity());
+        bestLine = ai.getPrincipalVariation();
+        bestLineScore = best.score;
+    }
+    catch (const std::runtime_error &)
+    {
+        // No legal moves, the panel shows that instead of a line
+        bestLineScore = 0.0f;
+    }
+}
+
+void Analysis::drawBestLinePanel(sf::RenderWindow &window, const sf::RectangleShape &panel)
+{
+    sf::RectangleShape bestLineButton = Utility::createButton(
+        sf::Vector2f(140, 30),
+        sf::Vector2f(panel.getPosition().x + 10, panel.getPosition().y + 10),
+        sf::Color::White);
+    Utility::drawButton(window, bestLineButton, "Best Line", 16);
+
+    // Only show a line calculated for the position on the board
+    if (bestLineMoveIndex != currentMoveIndex)
+        return;
+
+    float yPos = panel.getPosition().y + 50;
+    float maxY = panel.getPosition().y + panel.getSize().y - 10;
+
+    std::stringstream score;
+    score << "Score: " << std::fixed << std::setprecision(2) << bestLineScore;
+    sf::Text scoreText;
+    scoreText.setFont(Utility::getFont());
+    scoreText.setString(bestLine.empty() ? "No legal moves" : score.str());
+    scoreText.setCharacterSize(14);
+    scoreText.setFillColor(sf::Color(200, 200, 200));
+    scoreText.setPosition(panel.getPosition().x + 10, yPos);
+    window.draw(scoreText);
+    yPos += 22;
+
+    for (size_t i = 0; i < bestLine.size() && yPos < maxY; ++i)
+    {
+        sf::Text moveText;
+        moveText.setFont(Utility::getFont());
+        moveText.setString(formatMove(bestLine[i], currentMoveIndex + 1 + static_cast<int>(i)));
+        moveText.setCharacterSize(14);
+        moveText.setFillColor(i == 0 ? sf::Color::Yellow : sf::Color::White);
+        moveText.setPosition(panel.getPosition().x + 15, yPos);
+        window.draw(moveText);
+        yPos += 20;
+    }
+}
+
 void Analysis::drawAnalysisBoard(sf::RenderWindow &window, [[maybe_unused]] Render &render)
 {
     // Note: Board and pieces are drawn in game.cpp with zoomed view
@@ -672,6 +749,16 @@ void Analysis::drawAnalysisBoard(sf::RenderWindow &window, [[maybe_unused]] Rend
     
     // Draw captured pieces and game info
     drawCapturedPiecesPanel(window, infoPanel);
+
+    // Right panel below: engine best line
+    sf::RectangleShape bestLinePanel(sf::Vector2f(panelWidth, 200));
+    bestLinePanel.setPosition(static_cast<float>(window.getSize().x) - panelWidth - 10,
+                              static_cast<float>(window.getSize().y) - 340);
+    bestLinePanel.setFillColor(sf::Color(30, 30, 30, 240));
+    bestLinePanel.setOutlineColor(sf::Color::White);
+    bestLinePanel.setOutlineThickness(2);
+    window.draw(bestLinePanel);
+    drawBestLinePanel(window, bestLinePanel);
     
     // Draw navigation controls at bottom
     drawNavigationControls(window);
@@ -679,6 +766,7 @@ void Analysis::drawAnalysisBoard(sf::RenderWindow &window, [[maybe_unused]] Rend
 
 void Analysis::drawAnalysisScreen(sf::RenderWindow &window, Render &render)
 {
+    TRACE_ZONE("Analysis::drawAnalysisScreen");
     if (currentMode == AnalysisMode::Board)
     {
         // Analysis board mode - show the chessboard
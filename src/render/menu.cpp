@@ -6,9 +6,11 @@
 #include "utility.h"
 #include "state.h"
 #include "menu.h"
+#include "trace.h"
+#include "log.h"
 #include "render.h"
 
-extern Chessboard chessboard;
+extern thread_local Chessboard chessboard;
 extern Render render;
 
 sf::RectangleShape slider;
@@ -54,6 +56,7 @@ void Menu::drawSlider(sf::RenderWindow &window)
 
 void Menu::drawMenuScreen(sf::RenderWindow &window)
 {
+    TRACE_ZONE("Menu::drawMenuScreen");
     render.tintScreen(window);
     sf::Texture titleTexture;
 
@@ -77,7 +80,7 @@ void Menu::drawMenuScreen(sf::RenderWindow &window)
                 else if (logoShader.loadFromFile(shaderPath, sf::Shader::Fragment))
                 {
                     shaderLoaded = true;
-                    std::cout << "Logo shader loaded successfully from: " << shaderPath << std::endl;
+                    LOG_INFO("Logo shader loaded successfully from: " << shaderPath);
                 }
                 else
                 {
@@ -15,8 +15,22 @@
 #include "utility.h"
 #include "ai.h"
 #include "state.h"
+#include "trace.h"
 #include <SFML/Graphics.hpp>
 
+// State members holding graphics resources, kept with the renderer so the
+// engine library only depends on sfml-system
+std::map<std::string, sf::Sprite> State::images;
+sf::Sprite State::backgroundSprite;
+sf::Texture State::backgroundTexture;
+
+// Colors for the chess board and piece highlighting
+sf::Color State::colour1 = sf::Color(0xE5E5E5ff);
+sf::Color State::colour2 = sf::Color(0x26403Cff);
+sf::Color State::colourSelected = sf::Color(0x6290c8ff);
+sf::Color State::colourPrevMove = sf::Color(0x6290c855);
+sf::Color State::colourMove = sf::Color(0xFBFF1255);
+
 // Textures and sprites for chess pieces
 std::map<std::string, sf::Texture> textures;
 std::map<std::string, sf::Sprite> images;
@@ -114,6 +128,7 @@ void Render::highlightSquare(
 // Highlight selected square and possible moves
 void Render::highlightSquares(sf::RenderWindow &window)
 {
+    TRACE_ZONE("Render::highlightSquares");
     highlightSquare(window, State::selectedSquare);
 
     if (State::selectedPiece == "wKa" &&
@@ -152,6 +167,47 @@ void Render::highlightKing(
     }
 }
 
+// debug overlay in the top left with what the last AI search did
+void Render::drawSearchStats(sf::RenderWindow &window)
+{
+    TRACE_ZONE("Render::drawSearchStats");
+    const Types::SearchStats &stats = ai.getSearchStats();
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    ss << "depth " << stats.depth << " / seldepth " << stats.selectiveDepth << "\n"
+       << "nodes " << stats.nodes << " + " << stats.quiescenceNodes << " q\n"
+       << "nps " << static_cast<long long>(stats.nodesPerSecond) << "\n"
+       << "time " << stats.seconds << "s\n"
+       << "ebf " << stats.effectiveBranchingFactor << "\n"
+       << "tt " << stats.ttHits << "/" << stats.ttProbes
+       << " hits, " << stats.ttCutoffs << " cuts\n"
+       << "tablebase hits " << stats.tablebaseHits << "\n"
+       << "pawn hash " << stats.pawnHashHits << "/" << stats.pawnHashProbes << " hits\n"
+       << "eval cache " << stats.evalCacheHits << "/" << stats.evalCacheProbes << " hits\n"
+       << "first move cuts " << stats.firstMoveCutoffRate * 100.0 << "%\n";
+    for (const auto &iteration : stats.iterations)
+    {
+        ss << "  d" << iteration.depth << " " << iteration.score
+           << " " << iteration.nodes << "n " << iteration.seconds << "s\n";
+    }
+
+    sf::Text text;
+    text.setFont(Utility::getFont());
+    text.setString(ss.str());
+    text.setCharacterSize(14);
+    text.setFillColor(sf::Color::White);
+    text.setPosition(15, 15);
+
+    sf::FloatRect bounds = text.getGlobalBounds();
+    sf::RectangleShape background(sf::Vector2f(bounds.width + 20, bounds.height + 20));
+    background.setPosition(bounds.left - 10, bounds.top - 10);
+    background.setFillColor(sf::Color(0, 0, 0, 180));
+
+    window.draw(background);
+    window.draw(text);
+}
+
 void Render::drawExitButton(sf::RenderWindow &window)
 {
     sf::RectangleShape exitButton(sf::Vector2f(exitButtonSize, exitButtonSize));
@@ -192,6 +248,7 @@ void Render::drawExitButton(sf::RenderWindow &window)
 
 void Render::drawBoard(sf::RenderWindow &window)
 {
+    TRACE_ZONE("Render::drawBoard");
     sf::RectangleShape square(
         sf::Vector2f(Chessboard::squareSize, Chessboard::squareSize));
 
@@ -222,6 +279,7 @@ void Render::drawPieces(
     sf::RenderWindow &window,
     const std::map<std::string, sf::Sprite> &pieceImages)
 {
+    TRACE_ZONE("Render::drawPieces");
     auto boardState = chessboard.getBoardState();
 
     for (int row = 0; row < Chessboard::rows; ++row)
@@ -294,6 +352,7 @@ void Render::tintScreen(sf::RenderWindow &window)
 
 void Render::winScreen(sf::RenderWindow &window)
 {
+    TRACE_ZONE("Render::winScreen");
     if (State::winner != '-')
     {
         tintScreen(window);
@@ -364,6 +423,7 @@ void Render::winScreen(sf::RenderWindow &window)
 
 void Render::drawBackground(sf::RenderWindow &window, const sf::View &view)
 {
+    TRACE_ZONE("Render::drawBackground");
     // Get the current view center
     sf::Vector2f viewCenter = view.getCenter();
     
@@ -392,6 +452,7 @@ void Render::drawBackground(sf::RenderWindow &window, const sf::View &view)
 
 std::map<std::string, sf::Sprite> Render::loadImages(sf::RenderWindow &window)
 {
+    TRACE_ZONE("Render::loadImages");
     std::string assetPath = findAssetsPath("images/wood.png");
     if (!State::backgroundTexture.loadFromFile(assetPath))
     {
@@ -443,6 +504,7 @@ std::map<std::string, sf::Sprite> Render::loadImages(sf::RenderWindow &window)
 
 void Render::highlightPreviousMove(sf::RenderWindow &window)
 {
+    TRACE_ZONE("Render::highlightPreviousMove");
     if (!State::turnHistory.empty())
     {
         Types::Turn lastTurn = State::turnHistory.back();
@@ -469,6 +531,7 @@ void Render::drawCapturedPieces(
     sf::RenderWindow &window,
     const std::map<std::string, sf::Sprite> &pieceImages)
 {
+    TRACE_ZONE("Render::drawCapturedPieces");
     std::vector<int> numListw, numListb;
     std::vector<std::string> sortedListw, sortedListb;
     std::map<char, int> pieceToNum = {
@@ -570,6 +633,7 @@ int Render::getSpecing(int size)
 
 void Render::highlightKings(sf::RenderWindow &window)
 {
+    TRACE_ZONE("Render::highlightKings");
     Types::Coord whiteKingPosition, blackKingPosition;
     gameLogic->findAndSetKingPosition(whiteKingPosition, 'w');
     gameLogic->findAndSetKingPosition(blackKingPosition, 'b');
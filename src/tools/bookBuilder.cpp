@@ -0,0 +1,106 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+/**
+ * Opening book builder
+ *
+ * Replays the finished games in the games/ archive from the starting array
+ * and counts, for every position within the first plies, how often each move
+ * was played and how the game ended for the side that played it. Moves are
+ * weighted two points per win and one per draw, so moves that only ever lost
+ * stay in the file for the statistics but are never picked by the engine.
+ *
+ * usage: Tamerlane-Book-Builder [output (games/book.bin)] [max plies (24)]
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "chessboard.h"
+#include "database.h"
+#include "openingBook.h"
+#include "zobrist.h"
+
+using MoveKey = std::tuple<uint64_t, int, int, int, int>;
+
+int main(int argc, char *argv[])
+{
+    std::string output = (argc > 1) ? argv[1] : OpeningBook::DEFAULT_PATH;
+    int maxPlies = (argc > 2) ? std::stoi(argv[2]) : 24;
+
+    std::map<MoveKey, OpeningBook::Entry> moves;
+    int gamesUsed = 0;
+
+    for (const auto &game : Database::loadGameList())
+    {
+        char winner;
+        if (game.result == "1-0")
+            winner = 'w';
+        else if (game.result == "0-1")
+            winner = 'b';
+        else if (game.result == "1/2-1/2")
+            winner = '-';
+        else
+            continue; // unfinished games say nothing about the moves
+
+        Chessboard board;
+        board.resetBoard();
+        ++gamesUsed;
+
+        int plies = 0;
+        for (const auto &turn : game.turnHistory)
+        {
+            // stop at the end of the opening, at fortress moves and when the
+            // record stops matching the board (another starting array)
+            if (plies++ >= maxPlies ||
+                !board.isValidCoord(turn.initialSquare) ||
+                !board.isValidCoord(turn.finalSquare) ||
+                board.getPiece(turn.initialSquare) != turn.pieceMoved)
+                break;
+
+            uint64_t key = Zobrist::hash(board.getBoardState(), turn.player, false);
+            MoveKey moveKey{key, turn.initialSquare.x, turn.initialSquare.y,
+                            turn.finalSquare.x, turn.finalSquare.y};
+
+            auto inserted = moves.try_emplace(moveKey);
+            OpeningBook::Entry &entry = inserted.first->second;
+            if (inserted.second)
+            {
+                entry = OpeningBook::Entry{};
+                entry.key = key;
+                entry.fromX = static_cast<int8_t>(turn.initialSquare.x);
+                entry.fromY = static_cast<int8_t>(turn.initialSquare.y);
+                entry.toX = static_cast<int8_t>(turn.finalSquare.x);
+                entry.toY = static_cast<int8_t>(turn.finalSquare.y);
+            }
+
+            if (winner == '-')
+                ++entry.draws;
+            else if (winner == turn.player)
+                ++entry.wins;
+            else
+                ++entry.losses;
+
+            board.setCell(turn.initialSquare, "---");
+            board.setCell(turn.finalSquare, turn.pieceMoved);
+        }
+    }
+
+    std::vector<OpeningBook::Entry> entries;
+    entries.reserve(moves.size());
+    for (auto &[moveKey, entry] : moves)
+    {
+        uint32_t weight = entry.wins * 2 + entry.draws;
+        entry.weight = static_cast<uint16_t>(std::min<uint32_t>(weight, UINT16_MAX));
+        entries.push_back(entry);
+    }
+
+    if (!OpeningBook::write(output, entries))
+        return 1;
+
+    std::cout << "wrote " << entries.size() << " book moves from " << gamesUsed
+              << " games to " << output << std::endl;
+    return 0;
+}
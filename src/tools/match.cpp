@@ -0,0 +1,494 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+/**
+ * Engine match runner
+ *
+ * Plays two engine configurations against each other without a window, one
+ * game per worker thread on every core. Games come in pairs that share an
+ * opening, drawn from the opening book and followed by optional random
+ * moves, with the colours swapped, so neither side profits from a lucky
+ * opening. Every move is searched until a node budget is spent.
+ *
+ * After each game the score of the first engine, its Elo difference with a
+ * 95% interval and, with --sprt, the log-likelihood ratio of the sequential
+ * probability ratio test are printed. The match stops early once the test
+ * accepts either hypothesis. --archive saves every game to the games/
+ * archive through Database.
+ *
+ * An engine is given as one quoted argument of options:
+ *   --name s  --nodes n (20000)  --depth n (12)  --hash mb  --eval-cache mb
+ *   --no-null-move  --null-move-reduction n  --no-lmr  --lmr-full-depth-moves n
+ *   --lmr-base x  --lmr-divisor x  --eval-params path  --no-nnue
+ *
+ * usage: Tamerlane-Match --first "options" --second "options" [--games n (100)]
+ *                        [--threads n] [--book path] [--book-plies n (8)]
+ *                        [--random-plies n (0)] [--max-plies n (300)] [--alt]
+ *                        [--seed n] [--sprt elo0 elo1] [--alpha x] [--beta x]
+ *                        [--nnue path] [--archive]
+ *   e.g. Tamerlane-Match --first "--name tuned --eval-params eval.params"
+ *                        --second "--name default" --sprt 0 10
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "globals.h"
+#include "gameLogic.h"
+#include "database.h"
+#include "evaluation.h"
+#include "nnue.h"
+#include "openingBook.h"
+#include "zobrist.h"
+#include "log.h"
+
+struct EngineConfig
+{
+    std::string name;
+    Types::SearchOptions options;
+    int depth = 12;
+    Evaluation::Weights weights;
+};
+
+struct Settings
+{
+    EngineConfig engines[2];
+    int games = 100;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string bookPath = OpeningBook::DEFAULT_PATH;
+    int bookPlies = 8;
+    int randomPlies = 0;
+    int maxPlies = 300;
+    bool alt = false;
+    unsigned int seed = 1;
+    bool sprt = false;
+    double elo0 = 0.0;
+    double elo1 = 10.0;
+    double alpha = 0.05;
+    double beta = 0.05;
+    std::string networkPath;
+    bool archive = false;
+};
+
+static bool parseEngine(const std::string &spec, const std::string &defaultName,
+                        EngineConfig &engine)
+{
+    engine.name = defaultName;
+    engine.options.nodeLimit = 20000;
+    engine.options.useOpeningBook = false;
+
+    std::istringstream tokens(spec);
+    std::vector<std::string> args;
+    for (std::string token; tokens >> token;)
+        args.push_back(token);
+
+    for (size_t i = 0; i < args.size(); ++i)
+    {
+        const std::string &arg = args[i];
+        bool hasValue = i + 1 < args.size();
+        try
+        {
+            if (arg == "--name" && hasValue)
+                engine.name = args[++i];
+            else if (arg == "--nodes" && hasValue)
+                engine.options.nodeLimit = std::stoll(args[++i]);
+            else if (arg == "--depth" && hasValue)
+                engine.depth = std::clamp(std::stoi(args[++i]), 1, AI::MAX_PLY - 1);
+            else if (arg == "--hash" && hasValue)
+                engine.options.hashSizeMb = std::stoi(args[++i]);
+            else if (arg == "--eval-cache" && hasValue)
+                engine.options.evalCacheSizeMb = std::stoi(args[++i]);
+            else if (arg == "--no-null-move")
+                engine.options.nullMovePruning = false;
+            else if (arg == "--null-move-reduction" && hasValue)
+                engine.options.nullMoveReduction = std::stoi(args[++i]);
+            else if (arg == "--no-lmr")
+                engine.options.lateMoveReductions = false;
+            else if (arg == "--lmr-full-depth-moves" && hasValue)
+                engine.options.lateMoveFullDepthMoves = std::stoi(args[++i]);
+            else if (arg == "--lmr-base" && hasValue)
+                engine.options.lateMoveBase = std::stof(args[++i]);
+            else if (arg == "--lmr-divisor" && hasValue)
+                engine.options.lateMoveDivisor = std::stof(args[++i]);
+            else if (arg == "--no-nnue")
+                engine.options.useNnue = false;
+            else if (arg == "--eval-params" && hasValue)
+            {
+                // loaded on this thread and handed to the game threads
+                if (!Evaluation::loadWeights(args[++i]))
+                {
+                    std::cerr << "Could not load evaluation weights: " << args[i] << std::endl;
+                    return false;
+                }
+                engine.weights = Evaluation::weights();
+                Evaluation::setWeights(Evaluation::Weights());
+            }
+            else
+            {
+                std::cerr << "Unknown or incomplete engine option: " << arg << std::endl;
+                return false;
+            }
+        }
+        catch (const std::exception &)
+        {
+            std::cerr << "Invalid value for " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static double scoreToElo(double score)
+{
+    score = std::clamp(score, 1e-6, 1.0 - 1e-6);
+    // adding 0 turns an even score's -0 into 0
+    return -400.0 * std::log10(1.0 / score - 1.0) + 0.0;
+}
+
+static double eloToScore(double elo)
+{
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+// wins, draws and losses of the first engine
+struct Tally
+{
+    int wins = 0;
+    int draws = 0;
+    int losses = 0;
+
+    int games() const { return wins + draws + losses; }
+    double score() const { return (wins + 0.5 * draws) / games(); }
+    // variance of a single game's score
+    double variance() const
+    {
+        double s = score();
+        return (wins * (1.0 - s) * (1.0 - s) + draws * (0.5 - s) * (0.5 - s) +
+                losses * s * s) /
+               games();
+    }
+    // log-likelihood ratio of elo1 against elo0 in the normal approximation
+    double llr(double elo0, double elo1) const
+    {
+        double v = variance();
+        if (v <= 0.0)
+            return 0.0;
+        double s0 = eloToScore(elo0);
+        double s1 = eloToScore(elo1);
+        return (s1 - s0) * (2.0 * score() - s0 - s1) * games() / (2.0 * v);
+    }
+};
+
+// the same opening for both games of a pair, book moves while the book has
+// any and then random moves
+static std::vector<Types::Turn> pickOpening(const Settings &settings, const OpeningBook &book,
+                                           AI &ai, unsigned int pairSeed)
+{
+    std::mt19937 rng(pairSeed);
+    GameLogic gameLogic;
+    std::vector<Types::Turn> opening;
+    chessboard.resetBoard();
+
+    bool inBook = book.isOpen();
+    int randomMoves = 0;
+    for (int ply = 0; ply < settings.maxPlies; ++ply)
+    {
+        char player = (ply % 2 == 0) ? 'w' : 'b';
+        std::vector<Types::Turn> legalMoves = ai.generateAllLegalMoves(player, ply + 1, settings.alt);
+        if (legalMoves.empty())
+            break;
+
+        inBook = inBook && ply < settings.bookPlies;
+        std::vector<Types::Turn> candidates;
+        std::vector<uint32_t> weights;
+        if (inBook)
+        {
+            uint64_t key = Zobrist::hash(chessboard.getBoardState(), player, settings.alt);
+            for (const auto &entry : book.probe(key))
+            {
+                auto legal = std::find_if(legalMoves.begin(), legalMoves.end(),
+                                          [&](const Types::Turn &move)
+                                          {
+                                              return move.initialSquare.x == entry.fromX &&
+                                                     move.initialSquare.y == entry.fromY &&
+                                                     move.finalSquare.x == entry.toX &&
+                                                     move.finalSquare.y == entry.toY;
+                                          });
+                if (legal != legalMoves.end() && entry.weight > 0)
+                {
+                    candidates.push_back(*legal);
+                    weights.push_back(entry.weight);
+                }
+            }
+            inBook = !candidates.empty();
+        }
+
+        Types::Turn move;
+        if (inBook)
+        {
+            std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+            move = candidates[pick(rng)];
+        }
+        else if (randomMoves++ < settings.randomPlies)
+        {
+            std::uniform_int_distribution<size_t> pick(0, legalMoves.size() - 1);
+            move = legalMoves[pick(rng)];
+        }
+        else
+            break;
+
+        opening.push_back(move);
+        gameLogic.playMove(move);
+    }
+    return opening;
+}
+
+struct GameResult
+{
+    // white's result: 1 win, 0 draw, -1 loss
+    int result = 0;
+    std::vector<Types::Turn> history;
+    double seconds = 0.0;
+};
+
+static GameResult playGame(const Settings &settings, const std::vector<Types::Turn> &opening,
+                           const EngineConfig *configs[2], AI *players[2])
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    GameLogic gameLogic;
+    GameResult game;
+    std::unordered_map<uint64_t, int> seen;
+    chessboard.resetBoard();
+
+    for (int ply = 0; ply < settings.maxPlies; ++ply)
+    {
+        char player = (ply % 2 == 0) ? 'w' : 'b';
+        int side = (player == 'w') ? 0 : 1;
+        int turn = ply + 1;
+
+        if (!gameLogic.hasLegalMoves(player, settings.alt))
+        {
+            if (gameLogic.isKingInCheck(player, chessboard.getBoardState(), settings.alt))
+                game.result = (player == 'w') ? -1 : 1;
+            break;
+        }
+        if (++seen[Zobrist::hash(chessboard.getBoardState(), player, settings.alt)] >= 3)
+            break;
+
+        Types::Turn move;
+        if (ply < static_cast<int>(opening.size()))
+            move = opening[ply];
+        else
+        {
+            // each engine evaluates with its own weights, summed afresh
+            Evaluation::setWeights(configs[side]->weights);
+            chessboard.setBoard(chessboard.getBoardState());
+            move = players[side]->minMax(player, turn, settings.alt, configs[side]->depth,
+                                         -std::numeric_limits<float>::infinity(),
+                                         std::numeric_limits<float>::infinity());
+        }
+
+        move.turn = turn;
+        move.player = player;
+        move.pieceCaptured = chessboard.getPiece(move.finalSquare);
+        game.history.push_back(move);
+        gameLogic.playMove(move);
+    }
+
+    game.seconds = std::chrono::duration<double>(
+                       std::chrono::high_resolution_clock::now() - start)
+                       .count();
+    return game;
+}
+
+static std::string resultString(int result)
+{
+    return result > 0 ? "1-0" : result < 0 ? "0-1"
+                                            : "1/2-1/2";
+}
+
+int main(int argc, char *argv[])
+{
+    Settings settings;
+    std::string specs[2];
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try
+        {
+            if (arg == "--first" && hasValue)
+                specs[0] = argv[++i];
+            else if (arg == "--second" && hasValue)
+                specs[1] = argv[++i];
+            else if (arg == "--games" && hasValue)
+                settings.games = std::max(2, std::stoi(argv[++i]));
+            else if (arg == "--threads" && hasValue)
+                settings.threads = std::max(1, std::stoi(argv[++i]));
+            else if (arg == "--book" && hasValue)
+                settings.bookPath = argv[++i];
+            else if (arg == "--book-plies" && hasValue)
+                settings.bookPlies = std::stoi(argv[++i]);
+            else if (arg == "--random-plies" && hasValue)
+                settings.randomPlies = std::stoi(argv[++i]);
+            else if (arg == "--max-plies" && hasValue)
+                settings.maxPlies = std::stoi(argv[++i]);
+            else if (arg == "--alt")
+                settings.alt = true;
+            else if (arg == "--seed" && hasValue)
+                settings.seed = static_cast<unsigned int>(std::stoul(argv[++i]));
+            else if (arg == "--sprt" && i + 2 < argc)
+            {
+                settings.sprt = true;
+                settings.elo0 = std::stod(argv[++i]);
+                settings.elo1 = std::stod(argv[++i]);
+            }
+            else if (arg == "--alpha" && hasValue)
+                settings.alpha = std::stod(argv[++i]);
+            else if (arg == "--beta" && hasValue)
+                settings.beta = std::stod(argv[++i]);
+            else if (arg == "--nnue" && hasValue)
+                settings.networkPath = argv[++i];
+            else if (arg == "--archive")
+                settings.archive = true;
+            else
+            {
+                std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+                return 1;
+            }
+        }
+        catch (const std::exception &)
+        {
+            std::cerr << "Invalid value for " << arg << std::endl;
+            return 1;
+        }
+    }
+    // games are played in pairs with the colours swapped
+    settings.games += settings.games % 2;
+
+    if (!parseEngine(specs[0], "first", settings.engines[0]) ||
+        !parseEngine(specs[1], "second", settings.engines[1]))
+        return 1;
+    if (!settings.networkPath.empty() && !Nnue::load(settings.networkPath))
+    {
+        std::cerr << "Could not load network: " << settings.networkPath << std::endl;
+        return 1;
+    }
+
+    OpeningBook book;
+    if (settings.bookPlies > 0 && !book.open(settings.bookPath) &&
+        settings.bookPath != OpeningBook::DEFAULT_PATH)
+    {
+        std::cerr << "Could not load opening book: " << settings.bookPath << std::endl;
+        return 1;
+    }
+    if (!book.isOpen() && settings.randomPlies == 0)
+        std::cerr << "No opening book and no random plies, every pair plays the same game"
+                  << std::endl;
+
+    const double lowerBound = std::log(settings.beta / (1.0 - settings.alpha));
+    const double upperBound = std::log((1.0 - settings.beta) / settings.alpha);
+    const int firstGameId = settings.archive ? Database::getNextGameId() : 0;
+
+    // the search logs a line for every move, which would drown the match report
+    Log::setLevel(Log::Level::Warning);
+
+    std::atomic<int> nextPair{0};
+    std::atomic<bool> stop{false};
+    std::mutex reportMutex;
+    Tally tally;
+    std::string verdict;
+
+    auto report = [&](int game, const EngineConfig &white, const EngineConfig &black,
+                      const GameResult &played, int firstResult)
+    {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        if (firstResult > 0)
+            ++tally.wins;
+        else if (firstResult < 0)
+            ++tally.losses;
+        else
+            ++tally.draws;
+
+        double se = std::sqrt(tally.variance() / tally.games());
+        double elo = scoreToElo(tally.score());
+        double margin = (scoreToElo(tally.score() + 1.96 * se) -
+                         scoreToElo(tally.score() - 1.96 * se)) /
+                        2.0;
+        std::cerr << "game " << game + 1 << "/" << settings.games << " " << white.name << " vs "
+                  << black.name << ": " << resultString(played.result) << " in "
+                  << played.history.size() << " plies | " << settings.engines[0].name << " +"
+                  << tally.wins << " =" << tally.draws << " -" << tally.losses << ", Elo "
+                  << elo << " +- " << margin;
+        if (settings.sprt)
+        {
+            double llr = tally.llr(settings.elo0, settings.elo1);
+            std::cerr << ", LLR " << llr << " (" << lowerBound << ", " << upperBound << ")";
+            if (verdict.empty() && (llr <= lowerBound || llr >= upperBound))
+            {
+                verdict = llr >= upperBound ? "H1 accepted" : "H0 accepted";
+                stop = true;
+            }
+        }
+        std::cerr << std::endl;
+
+        if (settings.archive)
+        {
+            Types::GameRecord record;
+            record.id = firstGameId + game;
+            record.timestamp = Database::getCurrentTimestamp();
+            record.whitePlayer = white.name;
+            record.blackPlayer = black.name;
+            record.result = resultString(played.result);
+            record.totalMoves = static_cast<int>(played.history.size());
+            record.duration = static_cast<float>(played.seconds);
+            record.turnHistory = played.history;
+            Database::saveGame(record);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int worker = 0; worker < settings.threads; ++worker)
+    {
+        workers.emplace_back([&]()
+                             {
+            AI first(chessboard, settings.engines[0].options);
+            AI second(chessboard, settings.engines[1].options);
+
+            int pair;
+            while (!stop && (pair = nextPair.fetch_add(1)) < settings.games / 2)
+            {
+                std::vector<Types::Turn> opening = pickOpening(settings, book, first,
+                                                               settings.seed + static_cast<unsigned int>(pair));
+                for (int swap = 0; swap < 2 && !stop; ++swap)
+                {
+                    // the first engine has white in the first game of a pair
+                    const EngineConfig *configs[2] = {&settings.engines[swap], &settings.engines[1 - swap]};
+                    AI *players[2] = {swap ? &second : &first, swap ? &first : &second};
+                    GameResult played = playGame(settings, opening, configs, players);
+                    int firstResult = swap ? -played.result : played.result;
+                    report(pair * 2 + swap, *configs[0], *configs[1], played, firstResult);
+                }
+            } });
+    }
+    for (auto &worker : workers)
+        worker.join();
+
+    std::cout << settings.engines[0].name << " vs " << settings.engines[1].name << ": +"
+              << tally.wins << " =" << tally.draws << " -" << tally.losses << " in "
+              << tally.games() << " games, score "
+              << (tally.games() ? tally.score() * 100.0 : 0.0) << "%, Elo "
+              << (tally.games() ? scoreToElo(tally.score()) : 0.0);
+    if (!verdict.empty())
+        std::cout << ", SPRT " << verdict;
+    std::cout << std::endl;
+    return 0;
+}
@@ -0,0 +1,439 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+/**
+ * Differential move generation oracle
+ *
+ * Plays random legal games from the three starting arrays under both rule
+ * sets and checks every position the games pass through against the
+ * reference rules: the move lists GameLogic builds piece by piece from the
+ * PieceLogic generators, and its check test that replays every enemy move.
+ * The engine side must agree exactly:
+ *
+ *   moves     AI::generateAllLegalMoves gives the same from/to set
+ *   captures  AI::generateCaptureMoves gives the reference moves onto enemy pieces
+ *   check     GameLogic::attacksSquare finds an attacker of the Khan exactly
+ *             when isKingInCheck says it is in check
+ *   mate      GameLogic::hasLegalMoves agrees with the reference move list
+ *   board     generating moves leaves the board and its running keys as they were
+ *   running   after every move played, promotions and pawn forks included, the
+ *             evaluation terms and zobrist keys the board keeps up to date
+ *             equal Evaluation::staticTerms and keys computed from scratch
+ *
+ * so a faster generator can be swapped in behind any of them and run here
+ * first. A failing position is shrunk by taking pieces off for as long as
+ * the same check still fails, and printed in the notation of notation.h so
+ * `--position` reproduces it. A running mismatch depends on the moves that
+ * led to it, so the position before the move is printed with the move
+ * instead. Exits with 1 on any mismatch.
+ *
+ * usage: Tamerlane-Movegen-Oracle [--games n (20)] [--max-plies n (200)] [--seed n]
+ *                                 [--position "<notation>"]
+ */
+
+#include <algorithm>
+#include <iterator>
+#include <iostream>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "globals.h"
+#include "ai.h"
+#include "gameLogic.h"
+#include "log.h"
+#include "notation.h"
+#include "protocol.h"
+#include "zobrist.h"
+
+enum Check
+{
+    MOVES = 1 << 0,
+    CAPTURES = 1 << 1,
+    CHECK = 1 << 2,
+    MATE = 1 << 3,
+    BOARD = 1 << 4
+};
+
+static const char *checkName(int check)
+{
+    switch (check)
+    {
+    case MOVES:
+        return "moves";
+    case CAPTURES:
+        return "captures";
+    case CHECK:
+        return "check";
+    case MATE:
+        return "mate";
+    default:
+        return "board";
+    }
+}
+
+struct Move
+{
+    Types::Coord from;
+    Types::Coord to;
+
+    bool operator<(const Move &other) const
+    {
+        return std::tie(from.y, from.x, to.y, to.x) <
+               std::tie(other.from.y, other.from.x, other.to.y, other.to.x);
+    }
+    bool operator==(const Move &other) const
+    {
+        return from == other.from && to == other.to;
+    }
+};
+
+// the reference rules, nothing here goes through the AI
+static std::vector<Move> referenceMoves(GameLogic &gameLogic, char player, bool alt)
+{
+    std::vector<Move> moves;
+    for (int row = 0; row < Chessboard::rows; ++row)
+    {
+        for (int col = 0; col < Chessboard::cols; ++col)
+        {
+            Types::Coord from = {col, row};
+            Types::Piece piece = chessboard.getPiece(from);
+            if (piece.color() != player)
+                continue;
+            auto reach = gameLogic.getMoves(from, piece, player, alt);
+            for (const auto &to : gameLogic.filterLegalMoves(reach, from, piece, player, alt))
+                moves.push_back({from, to});
+        }
+    }
+    std::sort(moves.begin(), moves.end());
+    return moves;
+}
+
+// turns whose pieces do not match the board are kept off the list, so
+// they show up as missing
+static std::vector<Move> engineMoves(const std::vector<Types::Turn> &turns)
+{
+    std::vector<Move> moves;
+    for (const auto &turn : turns)
+    {
+        if (turn.pieceMoved == chessboard.getPiece(turn.initialSquare) &&
+            turn.pieceCaptured == chessboard.getPiece(turn.finalSquare))
+            moves.push_back({turn.initialSquare, turn.finalSquare});
+    }
+    std::sort(moves.begin(), moves.end());
+    return moves;
+}
+
+// in check when an enemy piece reaches the Khan, found the way
+// isKingInCheck finds it: the first K piece from black's side
+static bool attackedKhan(GameLogic &gameLogic, const Types::Board &board, char player, bool alt)
+{
+    Types::Coord khan = {-1, -1};
+    for (int row = 0; row < Chessboard::rows && khan.x < 0; ++row)
+    {
+        for (int col = 0; col < Chessboard::cols && khan.x < 0; ++col)
+        {
+            const Types::Piece &piece = board.board[row][col];
+            if (piece.color() == player && piece.piece() == 'K')
+                khan = {col, row};
+        }
+    }
+    if (khan.x < 0)
+        return false;
+
+    char enemy = (player == 'w') ? 'b' : 'w';
+    for (int row = 0; row < Chessboard::rows; ++row)
+    {
+        for (int col = 0; col < Chessboard::cols; ++col)
+        {
+            if (board.board[row][col].color() == enemy &&
+                gameLogic.attacksSquare(board, {col, row}, khan, alt))
+                return true;
+        }
+    }
+    return false;
+}
+
+static void printMoves(const char *label, const std::vector<Move> &moves)
+{
+    if (moves.empty())
+        return;
+    std::cout << "    " << label;
+    for (const auto &move : moves)
+        std::cout << " " << Protocol::squareName(move.from) << Protocol::squareName(move.to);
+    std::cout << std::endl;
+}
+
+// the checks that fail on the board, with what differs when verbose
+static int differences(AI &ai, GameLogic &gameLogic, char player, bool alt, bool verbose)
+{
+    int failed = 0;
+    const Types::Board before = chessboard.getBoardState();
+    const uint64_t pieceKey = chessboard.getPieceKey();
+    const uint64_t pawnKey = chessboard.getPawnKey();
+    const Evaluation::Terms terms = chessboard.getStaticTerms();
+
+    std::vector<Move> reference = referenceMoves(gameLogic, player, alt);
+    std::vector<Move> engine = engineMoves(ai.generateAllLegalMoves(player, 0, alt));
+    if (engine != reference)
+    {
+        failed |= MOVES;
+        if (verbose)
+        {
+            std::vector<Move> missing, extra;
+            std::set_difference(reference.begin(), reference.end(), engine.begin(), engine.end(),
+                                std::back_inserter(missing));
+            std::set_difference(engine.begin(), engine.end(), reference.begin(), reference.end(),
+                                std::back_inserter(extra));
+            printMoves("missing:", missing);
+            printMoves("extra:  ", extra);
+        }
+    }
+
+    std::vector<Move> referenceCaptures;
+    char enemy = (player == 'w') ? 'b' : 'w';
+    for (const auto &move : reference)
+    {
+        if (chessboard.getPiece(move.to).color() == enemy)
+            referenceCaptures.push_back(move);
+    }
+    std::vector<Move> captures = engineMoves(ai.generateCaptureMoves(player, alt));
+    if (captures != referenceCaptures)
+    {
+        failed |= CAPTURES;
+        if (verbose)
+        {
+            printMoves("reference captures:", referenceCaptures);
+            printMoves("engine captures:   ", captures);
+        }
+    }
+
+    bool inCheck = gameLogic.isKingInCheck(player, chessboard.getBoardState(), alt);
+    if (attackedKhan(gameLogic, chessboard.getBoardState(), player, alt) != inCheck)
+    {
+        failed |= CHECK;
+        if (verbose)
+            std::cout << "    isKingInCheck says " << (inCheck ? "in check" : "not in check")
+                      << ", attacksSquare disagrees" << std::endl;
+    }
+
+    if (gameLogic.hasLegalMoves(player, alt) == reference.empty())
+    {
+        failed |= MATE;
+        if (verbose)
+            std::cout << "    hasLegalMoves disagrees with " << reference.size()
+                      << " reference moves" << std::endl;
+    }
+
+    const Types::Board &after = chessboard.getBoardState();
+    bool boardKept = true;
+    for (int row = 0; row < Chessboard::rows; ++row)
+    {
+        for (int col = 0; col < Chessboard::cols; ++col)
+            boardKept = boardKept && after.board[row][col] == before.board[row][col];
+    }
+    if (!boardKept || chessboard.getPieceKey() != pieceKey ||
+        chessboard.getPawnKey() != pawnKey || !(chessboard.getStaticTerms() == terms))
+    {
+        failed |= BOARD;
+        if (verbose)
+            std::cout << "    the board or its keys changed while generating moves" << std::endl;
+        chessboard.setBoard(before);
+    }
+
+    return failed;
+}
+
+// the terms and keys setCell updates move by move against a full rescan
+static bool runningTermsAgree()
+{
+    const Types::Board &board = chessboard.getBoardState();
+    uint64_t pieceKey = 0;
+    uint64_t pawnKey = 0;
+    for (int row = 0; row < Chessboard::rows; ++row)
+    {
+        for (int col = 0; col < Chessboard::cols; ++col)
+        {
+            const Types::Piece &piece = board.board[row][col];
+            if (piece.color() == '-')
+                continue;
+            uint64_t key = Zobrist::pieceKey(row, col, piece);
+            pieceKey ^= key;
+            if (piece.type() == Types::PieceType::Pawn)
+                pawnKey ^= key;
+        }
+    }
+    return chessboard.getStaticTerms() == Evaluation::staticTerms(board) &&
+           chessboard.getPieceKey() == pieceKey && chessboard.getPawnKey() == pawnKey;
+}
+
+// takes pieces off one at a time, keeping every removal after which one
+// of the failing checks still fails, until no piece can go. Khans stay so
+// the check tests have something to look at
+static Notation::Position minimize(AI &ai, GameLogic &gameLogic,
+                                   Notation::Position position, int failed)
+{
+    bool shrunk = true;
+    while (shrunk)
+    {
+        shrunk = false;
+        for (int row = 0; row < Chessboard::rows; ++row)
+        {
+            for (int col = 0; col < Chessboard::cols; ++col)
+            {
+                Types::Piece piece = position.board.board[row][col];
+                if (piece == "---" || piece.piece() == 'K')
+                    continue;
+
+                Notation::Position smaller = position;
+                smaller.board.board[row][col] = Types::Piece();
+                chessboard.setBoard(smaller.board);
+                if (differences(ai, gameLogic, smaller.sideToMove, smaller.alt, false) & failed)
+                {
+                    position = smaller;
+                    shrunk = true;
+                }
+            }
+        }
+    }
+    return position;
+}
+
+// checks the position on the board, reports and shrinks it when it fails
+static bool verify(AI &ai, GameLogic &gameLogic, const Notation::Position &position)
+{
+    int failed = differences(ai, gameLogic, position.sideToMove, position.alt, false);
+    if (failed == 0)
+        return true;
+
+    std::cout << "mismatch:";
+    for (int check = MOVES; check <= BOARD; check <<= 1)
+    {
+        if (failed & check)
+            std::cout << " " << checkName(check);
+    }
+    std::cout << "\n  found:     " << Notation::toString(position) << std::endl;
+
+    Notation::Position minimal = minimize(ai, gameLogic, position, failed);
+    std::cout << "  minimized: " << Notation::toString(minimal) << std::endl;
+    chessboard.setBoard(minimal.board);
+    differences(ai, gameLogic, minimal.sideToMove, minimal.alt, true);
+
+    chessboard.setBoard(position.board);
+    return false;
+}
+
+int main(int argc, char *argv[])
+{
+    int games = 20;
+    int maxPlies = 200;
+    unsigned int seed = 1;
+    std::string single;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try
+        {
+            if (arg == "--games" && hasValue)
+                games = std::stoi(argv[++i]);
+            else if (arg == "--max-plies" && hasValue)
+                maxPlies = std::stoi(argv[++i]);
+            else if (arg == "--seed" && hasValue)
+                seed = static_cast<unsigned int>(std::stoul(argv[++i]));
+            else if (arg == "--position" && hasValue)
+                single = argv[++i];
+            else
+            {
+                std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+                return 1;
+            }
+        }
+        catch (const std::exception &)
+        {
+            std::cerr << "Invalid value for " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    // promotions and forks log a line each
+    Log::setLevel(Log::Level::Warning);
+
+    Types::SearchOptions options;
+    options.useOpeningBook = false;
+    options.useTablebases = false;
+    options.hashSizeMb = 1;
+    AI ai(chessboard, options);
+    GameLogic gameLogic;
+
+    if (!single.empty())
+    {
+        Notation::Position position;
+        if (!Notation::parse(single, position))
+        {
+            std::cerr << "Invalid position: " << single << std::endl;
+            return 1;
+        }
+        chessboard.setBoard(position.board);
+        bool agreed = verify(ai, gameLogic, position);
+        if (agreed)
+            std::cout << "all checks agree" << std::endl;
+        return agreed ? 0 : 1;
+    }
+
+    std::mt19937 rng(seed);
+    long long mismatches = 0;
+    for (const char *start : {Notation::MASCULINE, Notation::FEMININE, Notation::THIRD})
+    {
+        for (bool alt : {false, true})
+        {
+            long long positions = 0;
+            long long failedPositions = 0;
+            for (int game = 0; game < games; ++game)
+            {
+                Notation::Position position;
+                Notation::parse(start, position);
+                position.alt = alt;
+                chessboard.setBoard(position.board);
+
+                for (int ply = 0; ply < maxPlies; ++ply)
+                {
+                    position.board = chessboard.getBoardState();
+                    position.sideToMove = (ply % 2 == 0) ? 'w' : 'b';
+                    position.turn = ply + 1;
+                    ++positions;
+                    if (!verify(ai, gameLogic, position))
+                        ++failedPositions;
+
+                    std::vector<Move> moves = referenceMoves(gameLogic, position.sideToMove, alt);
+                    if (moves.empty())
+                        break;
+                    std::uniform_int_distribution<size_t> pick(0, moves.size() - 1);
+                    const Move &move = moves[pick(rng)];
+                    gameLogic.playMove({position.turn, position.sideToMove, move.from, move.to,
+                                        chessboard.getPiece(move.from),
+                                        chessboard.getPiece(move.to), 0.0f});
+
+                    if (!runningTermsAgree())
+                    {
+                        std::cout << "mismatch: running\n  before:    "
+                                  << Notation::toString(position) << "\n  move:      "
+                                  << Protocol::squareName(move.from)
+                                  << Protocol::squareName(move.to) << std::endl;
+                        ++failedPositions;
+                        // go on from a rescanned board
+                        chessboard.setBoard(chessboard.getBoardState());
+                    }
+                }
+            }
+
+            std::cout << (start == Notation::MASCULINE  ? "masculine"
+                          : start == Notation::FEMININE ? "feminine "
+                                                        : "third    ")
+                      << (alt ? " alt rules:      " : " standard rules: ")
+                      << positions << " positions, " << failedPositions << " mismatches"
+                      << std::endl;
+            mismatches += failedPositions;
+        }
+    }
+
+    return mismatches == 0 ? 0 : 1;
+}
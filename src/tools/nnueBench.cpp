@@ -0,0 +1,197 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+/**
+ * NNUE evaluation benchmark
+ *
+ * Replays every game in the games/ archive and times, over all positions,
+ * the hand written AI::evaluateBoard against the network: a full refresh of
+ * the accumulator, one incremental move (a piece taken off and put back)
+ * and the scalar and AVX2 forward passes. Both forward passes are checked
+ * to give the same output on every position.
+ *
+ * Without --net the material network is benchmarked, which also scores
+ * every position at exactly its material balance. --write-material saves
+ * that network as a starting point for training.
+ *
+ * usage: Tamerlane-NNUE-Bench [--net path] [--write-material path] [repetitions]
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "globals.h"
+#include "ai.h"
+#include "database.h"
+#include "nnue.h"
+
+static std::vector<Types::Board> collectPositions()
+{
+    std::vector<Types::Board> positions;
+    for (const auto &game : Database::loadGameList())
+    {
+        chessboard.resetBoard();
+        for (const auto &turn : game.turnHistory)
+        {
+            chessboard.setCell(turn.initialSquare, "---");
+            chessboard.setCell(turn.finalSquare, turn.pieceMoved);
+            positions.push_back(chessboard.getBoardState());
+        }
+    }
+    return positions;
+}
+
+template <typename Function>
+static double nanosecondsPer(long long calls, Function &&function)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    function();
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::nano> elapsed = end - start;
+    return calls ? elapsed.count() / calls : 0.0;
+}
+
+static float materialBalance(const Types::Board &board)
+{
+    float balance = 0.0f;
+    for (const auto &row : board.board)
+    {
+        for (const auto &piece : row)
+        {
+            if (piece.color() == 'w')
+                balance += Evaluation::pieceValue(piece);
+            else if (piece.color() == 'b')
+                balance -= Evaluation::pieceValue(piece);
+        }
+    }
+    return balance;
+}
+
+int main(int argc, char *argv[])
+{
+    std::string networkPath;
+    int repetitions = 20;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--net" && hasValue)
+            networkPath = argv[++i];
+        else if (arg == "--write-material" && hasValue)
+        {
+            if (!Nnue::write(argv[++i], *Nnue::materialNetwork()))
+                return 1;
+            std::cout << "wrote the material network to " << argv[i] << std::endl;
+            return 0;
+        }
+        else
+            repetitions = std::stoi(arg);
+    }
+
+    std::vector<Types::Board> positions = collectPositions();
+    if (positions.empty())
+    {
+        std::cout << "No positions found, is the games/ archive empty?" << std::endl;
+        return 1;
+    }
+
+    // the hand written evaluation first, before a network takes over
+    Types::SearchOptions options;
+    options.evalCacheSizeMb = 0;
+    options.useNnue = false;
+    AI ai(chessboard, options);
+    float checksum = 0.0f;
+    long long calls = static_cast<long long>(positions.size()) * repetitions;
+    double handWritten = nanosecondsPer(calls, [&]()
+                                        {
+        for (int rep = 0; rep < repetitions; ++rep)
+        {
+            for (const auto &board : positions)
+            {
+                chessboard.setBoard(board);
+                checksum += ai.evaluateBoard();
+            }
+        } });
+    std::cout << "hand written:    " << handWritten << " ns per eval (board setup included, checksum "
+              << checksum << ")" << std::endl;
+
+    bool material = networkPath.empty();
+    if (material)
+        Nnue::setNetwork(Nnue::materialNetwork());
+    else if (!Nnue::load(networkPath))
+    {
+        std::cerr << "Could not load network: " << networkPath << std::endl;
+        return 1;
+    }
+
+    std::vector<Nnue::Accumulator> accumulators(positions.size());
+    double refresh = nanosecondsPer(calls, [&]()
+                                    {
+        for (int rep = 0; rep < repetitions; ++rep)
+        {
+            for (size_t i = 0; i < positions.size(); ++i)
+                Nnue::refresh(positions[i], accumulators[i]);
+        } });
+
+    // every board lifts its first piece and puts it back like a move would
+    std::vector<int> firstFeatures;
+    for (const auto &board : positions)
+    {
+        int feature = -1;
+        for (int square = 0; square < Nnue::SQUARES && feature < 0; ++square)
+        {
+            int row = square / Chessboard::cols;
+            int col = square % Chessboard::cols;
+            feature = Nnue::feature(board.board[row][col], col, row);
+        }
+        firstFeatures.push_back(feature);
+    }
+    double incremental = nanosecondsPer(calls, [&]()
+                                        {
+        for (int rep = 0; rep < repetitions; ++rep)
+        {
+            for (size_t i = 0; i < positions.size(); ++i)
+            {
+                Nnue::removeFeature(accumulators[i], firstFeatures[i]);
+                Nnue::addFeature(accumulators[i], firstFeatures[i]);
+            }
+        } });
+
+    long long outputChecksum = 0;
+    double scalar = nanosecondsPer(calls, [&]()
+                                   {
+        for (int rep = 0; rep < repetitions; ++rep)
+        {
+            for (const auto &accumulator : accumulators)
+                outputChecksum += Nnue::forwardScalar(accumulator);
+        } });
+    double simd = nanosecondsPer(calls, [&]()
+                                 {
+        for (int rep = 0; rep < repetitions; ++rep)
+        {
+            for (const auto &accumulator : accumulators)
+                outputChecksum -= Nnue::forwardSimd(accumulator);
+        } });
+
+    int mismatches = 0;
+    int materialMismatches = 0;
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        if (Nnue::forwardScalar(accumulators[i]) != Nnue::forwardSimd(accumulators[i]))
+            ++mismatches;
+        if (material && Nnue::evaluate(accumulators[i]) != materialBalance(positions[i]))
+            ++materialMismatches;
+    }
+
+    std::cout << "nnue refresh:    " << refresh << " ns per board" << std::endl;
+    std::cout << "nnue update:     " << incremental
+              << " ns per piece moved (remove and add)" << std::endl;
+    std::cout << "nnue scalar:     " << scalar << " ns per forward pass" << std::endl;
+    std::cout << "nnue " << (Nnue::simdAvailable() ? "avx2:       " : "simd (none): ")
+              << simd << " ns per forward pass" << std::endl;
+    std::cout << positions.size() << " positions, " << mismatches
+              << " scalar/simd mismatches";
+    if (material)
+        std::cout << ", " << materialMismatches << " differ from the material balance";
+    std::cout << " (checksum " << outputChecksum << ")" << std::endl;
+    return mismatches == 0 && materialMismatches == 0 ? 0 : 1;
+}
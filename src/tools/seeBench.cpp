@@ -0,0 +1,100 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+/**
+ * Static exchange evaluation microbenchmark
+ *
+ * Replays every game in the games/ archive, collects the legal captures of
+ * each position and times AI::staticExchangeEvaluation over them for both
+ * the standard and the alt rule set. Prints the time per call and how many
+ * captures SEE classifies as losing (the ones pruned by quiescence search).
+ *
+ * usage: Tamerlane-SEE-Bench [repetitions]
+ */
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <string>
+#include "globals.h"
+#include "ai.h"
+#include "database.h"
+
+struct BenchPosition
+{
+    Types::Board board;
+    std::vector<Types::Turn> captures;
+};
+
+static std::vector<BenchPosition> collectPositions(AI &ai, bool alt)
+{
+    std::vector<BenchPosition> positions;
+
+    for (const auto &game : Database::loadGameList())
+    {
+        chessboard.resetBoard();
+
+        for (const auto &turn : game.turnHistory)
+        {
+            chessboard.setCell(turn.initialSquare, "---");
+            chessboard.setCell(turn.finalSquare, turn.pieceMoved);
+
+            char toMove = (turn.player == 'w') ? 'b' : 'w';
+            std::vector<Types::Turn> captures = ai.generateCaptureMoves(toMove, alt);
+            if (!captures.empty())
+            {
+                positions.push_back({chessboard.getBoardState(), captures});
+            }
+        }
+    }
+
+    return positions;
+}
+
+int main(int argc, char *argv[])
+{
+    int repetitions = (argc > 1) ? std::stoi(argv[1]) : 20;
+    AI ai(chessboard);
+
+    for (bool alt : {false, true})
+    {
+        std::vector<BenchPosition> positions = collectPositions(ai, alt);
+        if (positions.empty())
+        {
+            std::cout << "No captures found, is the games/ archive empty?" << std::endl;
+            return 1;
+        }
+
+        long long calls = 0;
+        long long losing = 0;
+        float checksum = 0.0f;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int rep = 0; rep < repetitions; ++rep)
+        {
+            for (const auto &position : positions)
+            {
+                chessboard.setBoard(position.board);
+                for (const auto &capture : position.captures)
+                {
+                    float see = ai.staticExchangeEvaluation(capture, alt);
+                    checksum += see;
+                    ++calls;
+                    if (rep == 0 && see < 0.0f)
+                        ++losing;
+                }
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double, std::nano> elapsed = end - start;
+
+        long long perRep = calls / repetitions;
+        std::cout << (alt ? "alt rules:      " : "standard rules: ")
+                  << positions.size() << " positions, "
+                  << perRep << " captures, "
+                  << losing << " losing ("
+                  << (perRep ? 100.0 * losing / perRep : 0.0) << "%), "
+                  << elapsed.count() / calls << " ns per SEE"
+                  << " (checksum " << checksum << ")" << std::endl;
+    }
+
+    return 0;
+}
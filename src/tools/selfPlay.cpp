@@ -0,0 +1,201 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+/**
+ * Self-play training data generator
+ *
+ * Plays the engine against itself without a window on every core, each
+ * move searched until a node budget is spent. The first plies of every game
+ * are random legal moves so games spread out from the starting array, the
+ * positions after them are streamed to a TrainingData file together with
+ * the search score, the ply and, once the game is over, its result.
+ *
+ * Games end by checkmate, stalemate, threefold repetition or, adjudicated
+ * as a draw, after the ply limit. The file is appended to, so runs can be
+ * stopped and resumed; records of unfinished games are never written.
+ *
+ * usage: Tamerlane-Self-Play [--games n (100)] [--threads n] [--nodes n (20000)]
+ *                            [--depth n (12)] [--random-plies n (8)]
+ *                            [--max-plies n (300)] [--alt] [--seed n]
+ *                            [--out path (games/selfplay.bin)]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "globals.h"
+#include "gameLogic.h"
+#include "trainingData.h"
+#include "zobrist.h"
+#include "log.h"
+
+struct Settings
+{
+    int games = 100;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    long long nodes = 20000;
+    int depth = 12;
+    int randomPlies = 8;
+    int maxPlies = 300;
+    bool alt = false;
+    unsigned int seed = 1;
+    std::string output = TrainingData::DEFAULT_PATH;
+};
+
+static int16_t scoreToRecord(float score)
+{
+    float hundredths = std::clamp(score * 100.0f, -32000.0f, 32000.0f);
+    return static_cast<int16_t>(hundredths);
+}
+
+// plays one game on this thread's board, returns white's result
+static int8_t playGame(const Settings &settings, AI &ai, std::mt19937 &rng,
+                       std::vector<TrainingData::Record> &records)
+{
+    GameLogic gameLogic;
+    std::unordered_map<uint64_t, int> seen;
+    chessboard.resetBoard();
+
+    for (int ply = 0; ply < settings.maxPlies; ++ply)
+    {
+        char player = (ply % 2 == 0) ? 'w' : 'b';
+        int turn = ply + 1;
+
+        std::vector<Types::Turn> legalMoves = ai.generateAllLegalMoves(player, turn, settings.alt);
+        if (legalMoves.empty())
+        {
+            if (gameLogic.isKingInCheck(player, chessboard.getBoardState(), settings.alt))
+                return player == 'w' ? -1 : 1;
+            return 0;
+        }
+        if (++seen[Zobrist::hash(chessboard.getBoardState(), player, settings.alt)] >= 3)
+            return 0;
+
+        Types::Turn move;
+        if (ply < settings.randomPlies)
+        {
+            std::uniform_int_distribution<size_t> pick(0, legalMoves.size() - 1);
+            move = legalMoves[pick(rng)];
+        }
+        else
+        {
+            move = ai.minMax(player, turn, settings.alt, settings.depth,
+                             -std::numeric_limits<float>::infinity(),
+                             std::numeric_limits<float>::infinity());
+
+            TrainingData::Record record;
+            if (TrainingData::pack(chessboard.getBoardState(), player, record))
+            {
+                record.score = scoreToRecord(move.score);
+                record.ply = static_cast<uint16_t>(ply);
+                records.push_back(record);
+            }
+        }
+
+        gameLogic.playMove(move);
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    Settings settings;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try
+        {
+            if (arg == "--games" && hasValue)
+                settings.games = std::stoi(argv[++i]);
+            else if (arg == "--threads" && hasValue)
+                settings.threads = std::max(1, std::stoi(argv[++i]));
+            else if (arg == "--nodes" && hasValue)
+                settings.nodes = std::stoll(argv[++i]);
+            else if (arg == "--depth" && hasValue)
+                settings.depth = std::clamp(std::stoi(argv[++i]), 1, AI::MAX_PLY - 1);
+            else if (arg == "--random-plies" && hasValue)
+                settings.randomPlies = std::stoi(argv[++i]);
+            else if (arg == "--max-plies" && hasValue)
+                settings.maxPlies = std::stoi(argv[++i]);
+            else if (arg == "--alt")
+                settings.alt = true;
+            else if (arg == "--seed" && hasValue)
+                settings.seed = static_cast<unsigned int>(std::stoul(argv[++i]));
+            else if (arg == "--out" && hasValue)
+                settings.output = argv[++i];
+            else
+            {
+                std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+                return 1;
+            }
+        }
+        catch (const std::exception &)
+        {
+            std::cerr << "Invalid value for " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    TrainingData::Writer writer;
+    if (!writer.open(settings.output))
+        return 1;
+
+    // the search logs a line for every move, which would drown the progress report
+    Log::setLevel(Log::Level::Warning);
+
+    std::atomic<int> nextGame{0};
+    std::mutex reportMutex;
+    int results[3] = {0, 0, 0}; // black wins, draws, white wins
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::thread> workers;
+    for (int worker = 0; worker < settings.threads; ++worker)
+    {
+        workers.emplace_back([&, worker]()
+                             {
+            Types::SearchOptions options;
+            options.nodeLimit = settings.nodes;
+            options.useOpeningBook = false;
+            options.hashSizeMb = 8;
+            options.seed = settings.seed + static_cast<unsigned int>(worker);
+            AI ai(chessboard, options);
+            std::mt19937 rng(options.seed);
+            std::vector<TrainingData::Record> records;
+
+            int game;
+            while ((game = nextGame.fetch_add(1)) < settings.games)
+            {
+                records.clear();
+                int8_t result = playGame(settings, ai, rng, records);
+                for (auto &record : records)
+                    record.result = result;
+                writer.write(records);
+
+                std::lock_guard<std::mutex> lock(reportMutex);
+                ++results[result + 1];
+                double seconds = std::chrono::duration<double>(
+                                     std::chrono::high_resolution_clock::now() - start)
+                                     .count();
+                std::cerr << "game " << game + 1 << "/" << settings.games << ": "
+                          << (result > 0 ? "1-0" : result < 0 ? "0-1" : "1/2-1/2")
+                          << ", " << records.size() << " positions (+" << results[2]
+                          << " =" << results[1] << " -" << results[0] << ", "
+                          << seconds << "s)" << std::endl;
+            } });
+    }
+    for (auto &worker : workers)
+        worker.join();
+    writer.close();
+
+    std::cout << "wrote " << writer.written() << " positions from " << settings.games
+              << " games to " << settings.output << std::endl;
+    return 0;
+}
@@ -0,0 +1,627 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+/**
+ * Endgame tablebase generator
+ *
+ * Builds distance-to-mate tables for pawnless Khan endings of up to four
+ * pieces by retrograde analysis. One scan over the table marks impossible
+ * positions, mates and stalemates, and looks captures up in the smaller
+ * tables, which are built first when they are missing. Pass n then works
+ * back from the positions pass n - 1 decided: taking a move back from a
+ * lost position gives a win in n plies, and taking one back from a won
+ * position gives a candidate that is lost in n plies once every move it
+ * has leads to a win decided earlier. Captures that win or lose only later
+ * put their position up for that pass. A Khan next to its fortress can
+ * step in and draw instead of losing, as in GameLogic::canDraw, so the
+ * side to move there is never lost unless mated. Whatever is left
+ * undecided is a draw.
+ *
+ * The scan and every pass are split over worker threads.
+ *
+ * usage: Tamerlane-Tablebase-Gen [--alt] [--threads n] [--out dir] material...
+ *   e.g. Tamerlane-Tablebase-Gen KGvK KRvK KGvKM
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "globals.h"
+#include "gameLogic.h"
+#include "tablebase.h"
+
+static constexpr uint8_t UNKNOWN = 254;
+// undecided but already looked at in this pass
+static constexpr uint8_t CHECKED = 253;
+static constexpr uint64_t CHUNK_SIZE = 4096;
+
+struct Successor
+{
+    bool inTable;
+    uint64_t index; // in this table when inTable
+    uint8_t value;  // from a smaller table otherwise
+};
+
+// what one worker thread found, merged once the threads are done
+struct Findings
+{
+    std::vector<uint64_t> decided;
+    std::vector<uint64_t> checked;
+    // by pass, positions a capture decides or may decide then
+    std::vector<std::vector<uint64_t>> captureWins;
+    std::vector<std::vector<uint64_t>> captureLosses;
+    std::vector<Successor> successors;
+};
+
+class Generator
+{
+public:
+    Generator(const Tablebase::Material &material, bool alt, int threads,
+              const Tablebase &smallerTables)
+        : material(material), alt(alt), threads(threads), smallerTables(smallerTables),
+          pieces(Tablebase::tablePieces(material)),
+          pieceCount(material.pieceCount()),
+          size(Tablebase::tableSize(material.pieceCount())),
+          values(new std::atomic<uint8_t>[size]),
+          captureWins(PASSES), captureLosses(PASSES)
+    {
+    }
+
+    bool run(std::vector<uint8_t> &result);
+
+private:
+    // distances up to MAX_DISTANCE, each decided in the pass of that number
+    static constexpr int PASSES = Tablebase::MAX_DISTANCE + 2;
+
+    const Tablebase::Material &material;
+    bool alt;
+    int threads;
+    const Tablebase &smallerTables;
+    std::vector<Types::Piece> pieces;
+    int pieceCount;
+    uint64_t size;
+    std::unique_ptr<std::atomic<uint8_t>[]> values;
+
+    // squares each piece can reach a square from on an empty board, the
+    // ones a move could have come from
+    std::vector<std::array<std::vector<int>, Tablebase::SQUARES>> origins;
+    std::vector<uint64_t> decided; // in the last pass
+    std::vector<std::vector<uint64_t>> captureWins;
+    std::vector<std::vector<uint64_t>> captureLosses;
+    std::atomic<bool> failed{false};
+
+    template <typename Work>
+    void parallel(uint64_t count, Work work);
+    void scan();
+    void retrogradePass(int pass);
+    uint8_t classify(uint64_t index, Findings &findings);
+    bool lostIn(uint64_t index, int pass, std::vector<Successor> &successors);
+    void decide(uint64_t index, int pass, Findings &findings);
+    template <typename Visit>
+    void forEachPredecessor(uint64_t index, Visit visit);
+    void findOrigins();
+    void placePieces(const int *squares);
+    void clearPieces(const int *squares);
+    bool generateSuccessors(const int *squares, char player,
+                            std::vector<Successor> &successors, bool &inCheck);
+};
+
+static Types::Coord toCoord(int square)
+{
+    return {square % Chessboard::cols, square / Chessboard::cols};
+}
+
+// squares next to a side's fortress, from where the Khan can enter it
+static bool nextToFortress(char player, int square)
+{
+    Types::Coord coord = toCoord(square);
+    if (player == 'w')
+        return coord.x == 0 && coord.y <= 2;
+    return coord.x == Chessboard::cols - 1 && coord.y >= Chessboard::rows - 3;
+}
+
+// puts the position on this thread's board
+void Generator::placePieces(const int *squares)
+{
+    for (int i = 0; i < pieceCount; ++i)
+        chessboard.setCell(toCoord(squares[i]), pieces[i]);
+}
+
+void Generator::clearPieces(const int *squares)
+{
+    for (int i = 0; i < pieceCount; ++i)
+        chessboard.setCell(toCoord(squares[i]), "---");
+}
+
+// legal moves of the side to move as positions of this or a smaller table
+bool Generator::generateSuccessors(const int *squares, char player,
+                                   std::vector<Successor> &successors,
+                                   bool &inCheck)
+{
+    GameLogic gameLogic;
+    const char opponent = (player == 'w') ? 'b' : 'w';
+    const int khanSlot = (player == 'w') ? 0 : 1;
+    const Types::Board &board = chessboard.getBoardState();
+
+    successors.clear();
+    inCheck = false;
+    for (int j = 0; j < pieceCount; ++j)
+    {
+        if (pieces[j].color() == opponent &&
+            gameLogic.attacksSquare(board, toCoord(squares[j]), toCoord(squares[khanSlot]), alt))
+            inCheck = true;
+    }
+
+    int moved[Tablebase::MAX_PIECES];
+    for (int i = 0; i < pieceCount; ++i)
+    {
+        if (pieces[i].color() != player)
+            continue;
+
+        Types::Coord from = toCoord(squares[i]);
+        for (const Types::Coord &to : gameLogic.getMoves(from, pieces[i], player, alt))
+        {
+            int target = to.y * Chessboard::cols + to.x;
+            int captured = -1;
+            for (int j = 0; j < pieceCount; ++j)
+            {
+                if (squares[j] == target)
+                    captured = j;
+            }
+
+            chessboard.setCell(to, pieces[i]);
+            chessboard.setCell(from, "---");
+
+            int khanSquare = (i == khanSlot) ? target : squares[khanSlot];
+            bool legal = true;
+            for (int j = 0; j < pieceCount && legal; ++j)
+            {
+                if (j != captured && pieces[j].color() == opponent &&
+                    gameLogic.attacksSquare(board, toCoord(squares[j]), toCoord(khanSquare), alt))
+                    legal = false;
+            }
+
+            if (legal && captured < 0)
+            {
+                std::copy(squares, squares + pieceCount, moved);
+                moved[i] = target;
+                successors.push_back({true, Tablebase::index(pieceCount, moved, opponent), 0});
+            }
+            else if (legal && pieceCount == 3)
+            {
+                // only the two Khans are left
+                successors.push_back({false, 0, Tablebase::DRAW});
+            }
+            else if (legal)
+            {
+                Tablebase::ProbeResult result;
+                if (!smallerTables.probe(board, opponent, alt, result))
+                {
+                    std::cerr << "Missing smaller table for a capture in "
+                              << material.name() << std::endl;
+                    failed = true;
+                }
+                uint8_t value = (result.outcome == Tablebase::Outcome::Draw)
+                                    ? Tablebase::DRAW
+                                    : static_cast<uint8_t>(result.distance + 1);
+                successors.push_back({false, 0, value});
+            }
+
+            chessboard.setCell(from, pieces[i]);
+            chessboard.setCell(to, captured >= 0 ? pieces[captured] : Types::Piece("---"));
+        }
+    }
+    return !failed;
+}
+
+void Generator::findOrigins()
+{
+    GameLogic gameLogic;
+    Types::Board board;
+    origins.resize(pieceCount);
+    for (int i = 0; i < pieceCount; ++i)
+    {
+        for (int from = 0; from < Tablebase::SQUARES; ++from)
+        {
+            Types::Coord coord = toCoord(from);
+            board.board[coord.y][coord.x] = pieces[i];
+            for (int to = 0; to < Tablebase::SQUARES; ++to)
+            {
+                if (gameLogic.attacksSquare(board, coord, toCoord(to), alt))
+                    origins[i][to].push_back(from);
+            }
+            board.board[coord.y][coord.x] = "---";
+        }
+    }
+}
+
+// positions one non-capturing move before this one, the tables below hold
+// the positions before a capture
+template <typename Visit>
+void Generator::forEachPredecessor(uint64_t index, Visit visit)
+{
+    int squares[Tablebase::MAX_PIECES];
+    char player;
+    Tablebase::decode(index, pieceCount, squares, player);
+    const char mover = (player == 'w') ? 'b' : 'w';
+
+    GameLogic gameLogic;
+    Types::Board board;
+    for (int i = 0; i < pieceCount; ++i)
+    {
+        Types::Coord coord = toCoord(squares[i]);
+        board.board[coord.y][coord.x] = pieces[i];
+    }
+
+    int moved[Tablebase::MAX_PIECES];
+    for (int i = 0; i < pieceCount; ++i)
+    {
+        if (pieces[i].color() != mover)
+            continue;
+
+        Types::Coord to = toCoord(squares[i]);
+        board.board[to.y][to.x] = "---";
+        for (int from : origins[i][squares[i]])
+        {
+            // blockers only take squares away, so the board decides the rest
+            Types::Coord coord = toCoord(from);
+            if (board.board[coord.y][coord.x] != "---")
+                continue;
+            board.board[coord.y][coord.x] = pieces[i];
+            if (gameLogic.attacksSquare(board, coord, to, alt))
+            {
+                std::copy(squares, squares + pieceCount, moved);
+                moved[i] = from;
+                uint64_t predecessor = Tablebase::index(pieceCount, moved, mover);
+                if (predecessor != Tablebase::NO_INDEX)
+                    visit(predecessor);
+            }
+            board.board[coord.y][coord.x] = "---";
+        }
+        board.board[to.y][to.x] = pieces[i];
+    }
+}
+
+// value of the position before any pass, UNKNOWN unless it is impossible,
+// mate or stalemate. Captures into smaller tables are filed for the pass
+// that can decide them
+uint8_t Generator::classify(uint64_t index, Findings &findings)
+{
+    int squares[Tablebase::MAX_PIECES];
+    char player;
+    Tablebase::decode(index, pieceCount, squares, player);
+    const char opponent = (player == 'w') ? 'b' : 'w';
+
+    placePieces(squares);
+
+    // the side that just moved can't have left its Khan attacked
+    GameLogic gameLogic;
+    const int opponentKhan = (opponent == 'w') ? 0 : 1;
+    for (int j = 0; j < pieceCount; ++j)
+    {
+        if (pieces[j].color() == player &&
+            gameLogic.attacksSquare(chessboard.getBoardState(), toCoord(squares[j]),
+                                    toCoord(squares[opponentKhan]), alt))
+        {
+            clearPieces(squares);
+            return Tablebase::INVALID;
+        }
+    }
+
+    bool inCheck;
+    std::vector<Successor> &successors = findings.successors;
+    generateSuccessors(squares, player, successors, inCheck);
+    clearPieces(squares);
+
+    // stalemate is a draw like in the search, and mate ends the game even
+    // next to the fortress
+    if (successors.empty())
+        return inCheck ? 1 : Tablebase::DRAW;
+
+    int captureWin = INT_MAX;
+    int captureLoss = 0;
+    bool captures = false;
+    bool captureHolds = false;
+    for (const auto &successor : successors)
+    {
+        if (successor.inTable)
+            continue;
+        captures = true;
+        if (successor.value == Tablebase::DRAW)
+        {
+            captureHolds = true;
+            continue;
+        }
+
+        int distance = successor.value - 1;
+        if (distance % 2 == 0)
+            captureWin = std::min(captureWin, distance + 1);
+        else
+            captureLoss = std::max(captureLoss, distance + 1);
+    }
+
+    if (captureWin != INT_MAX)
+        findings.captureWins[std::min(captureWin, PASSES - 1)].push_back(index);
+    else if (captures && !captureHolds)
+        findings.captureLosses[std::min(captureLoss, PASSES - 1)].push_back(index);
+    return UNKNOWN;
+}
+
+// whether every move of the position leads to a win for the opponent
+// decided before this pass, and the Khan can't take refuge in its fortress
+bool Generator::lostIn(uint64_t index, int pass, std::vector<Successor> &successors)
+{
+    int squares[Tablebase::MAX_PIECES];
+    char player;
+    Tablebase::decode(index, pieceCount, squares, player);
+    if (nextToFortress(player, squares[player == 'w' ? 0 : 1]))
+        return false;
+
+    bool inCheck;
+    placePieces(squares);
+    generateSuccessors(squares, player, successors, inCheck);
+    clearPieces(squares);
+
+    for (const auto &successor : successors)
+    {
+        uint8_t value = successor.inTable
+                            ? values[successor.index].load(std::memory_order_relaxed)
+                            : successor.value;
+        if (value == Tablebase::DRAW || value >= CHECKED)
+            return false;
+        int distance = value - 1;
+        if (distance % 2 == 0 || distance >= pass)
+            return false;
+    }
+    return !successors.empty();
+}
+
+// settles an undecided position the pass reached, wins straight away and
+// losses once every move is checked
+void Generator::decide(uint64_t index, int pass, Findings &findings)
+{
+    const uint8_t value = static_cast<uint8_t>(pass + 1);
+    uint8_t expected = UNKNOWN;
+    if (pass % 2 == 1)
+    {
+        if (values[index].compare_exchange_strong(expected, value, std::memory_order_relaxed))
+            findings.decided.push_back(index);
+        return;
+    }
+
+    // a candidate reached twice in one pass is only checked once
+    if (!values[index].compare_exchange_strong(expected, CHECKED, std::memory_order_relaxed))
+        return;
+    if (lostIn(index, pass, findings.successors))
+    {
+        values[index].store(value, std::memory_order_relaxed);
+        findings.decided.push_back(index);
+    }
+    else
+    {
+        findings.checked.push_back(index);
+    }
+}
+
+template <typename Work>
+void Generator::parallel(uint64_t count, Work work)
+{
+    std::vector<Findings> found(threads);
+    std::atomic<uint64_t> nextChunk{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([this, &work, &found, &nextChunk, count, t]()
+                             {
+            chessboard.setBoard(Types::Board());
+            Findings &findings = found[t];
+            findings.captureWins.resize(PASSES);
+            findings.captureLosses.resize(PASSES);
+            while (true)
+            {
+                uint64_t begin = nextChunk.fetch_add(CHUNK_SIZE);
+                if (begin >= count)
+                    break;
+                uint64_t end = std::min(count, begin + CHUNK_SIZE);
+                for (uint64_t i = begin; i < end; ++i)
+                    work(i, findings);
+            } });
+    }
+    for (auto &worker : workers)
+        worker.join();
+
+    decided.clear();
+    for (auto &findings : found)
+    {
+        decided.insert(decided.end(), findings.decided.begin(), findings.decided.end());
+        for (uint64_t index : findings.checked)
+            values[index].store(UNKNOWN, std::memory_order_relaxed);
+        for (int pass = 0; pass < PASSES; ++pass)
+        {
+            captureWins[pass].insert(captureWins[pass].end(),
+                                     findings.captureWins[pass].begin(),
+                                     findings.captureWins[pass].end());
+            captureLosses[pass].insert(captureLosses[pass].end(),
+                                       findings.captureLosses[pass].begin(),
+                                       findings.captureLosses[pass].end());
+        }
+    }
+}
+
+void Generator::scan()
+{
+    parallel(size, [this](uint64_t index, Findings &findings)
+             {
+        uint8_t value = classify(index, findings);
+        values[index].store(value, std::memory_order_relaxed);
+        if (value == 1)
+            findings.decided.push_back(index); });
+}
+
+void Generator::retrogradePass(int pass)
+{
+    // the capture candidates go first as one more batch of work
+    std::vector<uint64_t> previous;
+    previous.swap(decided);
+    std::vector<uint64_t> &captured = (pass % 2 == 1) ? captureWins[pass] : captureLosses[pass];
+    const uint64_t fromCaptures = captured.size();
+
+    parallel(fromCaptures + previous.size(),
+             [this, pass, &previous, &captured, fromCaptures](uint64_t i, Findings &findings)
+             {
+        if (i < fromCaptures)
+        {
+            decide(captured[i], pass, findings);
+            return;
+        }
+        forEachPredecessor(previous[i - fromCaptures], [&](uint64_t predecessor)
+                           {
+            if (values[predecessor].load(std::memory_order_relaxed) == UNKNOWN)
+                decide(predecessor, pass, findings); }); });
+
+    std::vector<uint64_t>().swap(captured);
+}
+
+bool Generator::run(std::vector<uint8_t> &result)
+{
+    findOrigins();
+    scan();
+    std::cout << "  scan: " << decided.size() << " mates" << std::endl;
+
+    for (int pass = 1; pass < PASSES && !failed; ++pass)
+    {
+        bool pending = !decided.empty();
+        for (int later = pass; later < PASSES && !pending; ++later)
+            pending = !captureWins[later].empty() || !captureLosses[later].empty();
+        if (!pending)
+            break;
+
+        retrogradePass(pass);
+        if (!decided.empty())
+            std::cout << "  pass " << pass << ": " << decided.size() << " positions decided" << std::endl;
+        if (!decided.empty() && pass > Tablebase::MAX_DISTANCE)
+        {
+            std::cerr << "Mate longer than " << Tablebase::MAX_DISTANCE << " plies in "
+                      << material.name() << std::endl;
+            failed = true;
+        }
+    }
+    if (failed)
+        return false;
+
+    // whatever never got decided can be held forever
+    result.resize(size);
+    for (uint64_t index = 0; index < size; ++index)
+    {
+        uint8_t value = values[index].load(std::memory_order_relaxed);
+        result[index] = (value == UNKNOWN) ? Tablebase::DRAW : value;
+    }
+    return true;
+}
+
+static bool buildTable(const Tablebase::Material &material, bool alt, int threads,
+                       const std::string &directory)
+{
+    std::string path = directory + "/" + Tablebase::fileName(material, alt);
+    std::string swappedPath = directory + "/" + Tablebase::fileName(material.swapped(), alt);
+    if (std::filesystem::exists(path) || std::filesystem::exists(swappedPath))
+        return true;
+
+    // tables reached by a capture come first
+    for (const std::string *side : {&material.white, &material.black})
+    {
+        for (size_t i = 0; i < side->size(); ++i)
+        {
+            Tablebase::Material smaller = material;
+            std::string &pieces = (side == &material.white) ? smaller.white : smaller.black;
+            pieces.erase(i, 1);
+            if (smaller.pieceCount() > 2 && !buildTable(smaller, alt, threads, directory))
+                return false;
+        }
+    }
+
+    Tablebase smallerTables;
+    smallerTables.load(directory);
+
+    std::cout << "generating " << Tablebase::fileName(material, alt) << " ("
+              << Tablebase::tableSize(material.pieceCount()) << " positions, "
+              << threads << " threads)" << std::endl;
+    auto start = std::chrono::steady_clock::now();
+
+    Generator generator(material, alt, threads, smallerTables);
+    std::vector<uint8_t> values;
+    if (!generator.run(values))
+    {
+        std::cerr << "failed to generate " << material.name() << std::endl;
+        return false;
+    }
+
+    long long wins = 0, losses = 0, draws = 0;
+    int longest = 0;
+    for (uint8_t value : values)
+    {
+        if (value == Tablebase::INVALID)
+            continue;
+        Tablebase::ProbeResult result = Tablebase::decodeValue(value);
+        if (result.outcome == Tablebase::Outcome::Win)
+            ++wins;
+        else if (result.outcome == Tablebase::Outcome::Loss)
+            ++losses;
+        else
+            ++draws;
+        longest = std::max(longest, result.distance);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  " << wins << " wins, " << losses << " losses, " << draws
+              << " draws, longest mate " << longest << " plies, " << seconds << "s" << std::endl;
+
+    return Tablebase::write(path, material, alt, values);
+}
+
+int main(int argc, char *argv[])
+{
+    bool alt = false;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::string directory = Tablebase::DEFAULT_DIRECTORY;
+    std::vector<Tablebase::Material> materials;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        Tablebase::Material material;
+        if (arg == "--alt")
+            alt = true;
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--out" && i + 1 < argc)
+            directory = argv[++i];
+        else if (material.parse(arg) && material.pieceCount() > 2)
+            materials.push_back(material);
+        else
+        {
+            std::cerr << "Unknown argument or material: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    if (materials.empty())
+    {
+        std::cerr << "usage: Tamerlane-Tablebase-Gen [--alt] [--threads n] [--out dir] material..." << std::endl;
+        return 1;
+    }
+
+    std::filesystem::create_directories(directory);
+    for (const auto &material : materials)
+    {
+        if (!buildTable(material, alt, threads, directory))
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,452 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+/**
+ * Texel evaluation tuner
+ *
+ * Collects quiet positions, where the side to move is not in check and has
+ * no capture that wins material by static exchange, together with the result
+ * of the game they come from. Positions are replayed from the finished games
+ * in the games/ archive, read from the TrainingData files Tamerlane-Self-Play
+ * writes and from text files with one position per line, given as
+ * GameLogic::getPositionHash or in the notation of notation.h, followed by
+ * the result ("1-0", "0-1" or "1/2-1/2").
+ *
+ * The evaluation is mapped to an expected score by 1 / (1 + 10^(-K * eval / 4))
+ * and the mean squared difference to the results is minimised. K is fitted to
+ * the starting weights first, then every weight is nudged up and down by a
+ * step that halves whenever a whole pass brings no improvement. The error is
+ * summed over the positions by a pool of worker threads kept for the whole
+ * run, each evaluating its own range on its own board.
+ *
+ * usage: Tamerlane-Texel-Tuner [--positions file]... [--data file]...
+ *                              [--sample n] [--threads n]
+ *                              [--skip-plies n (8)] [--passes n (50)]
+ *                              [--out path (eval.params)]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "globals.h"
+#include "gameLogic.h"
+#include "database.h"
+#include "evaluation.h"
+#include "notation.h"
+#include "trainingData.h"
+
+struct TrainingPosition
+{
+    Types::Board board;
+    float result; // white's score, 1 win, 0.5 draw, 0 loss
+};
+
+static bool parseResult(const std::string &result, float &score)
+{
+    if (result == "1-0")
+        score = 1.0f;
+    else if (result == "0-1")
+        score = 0.0f;
+    else if (result == "1/2-1/2")
+        score = 0.5f;
+    else
+        return false;
+    return true;
+}
+
+// the side to move is out of check and cannot win material right away, so
+// the static evaluation is a fair guess at the position
+static bool isQuiet(AI &ai, GameLogic &gameLogic, char toMove)
+{
+    if (gameLogic.isKingInCheck(toMove, chessboard.getBoardState(), false))
+        return false;
+    for (const auto &capture : ai.generateCaptureMoves(toMove, false))
+    {
+        if (ai.staticExchangeEvaluation(capture, false) > 0.0f)
+            return false;
+    }
+    return true;
+}
+
+static int collectArchive(AI &ai, int skipPlies, std::vector<TrainingPosition> &positions)
+{
+    GameLogic gameLogic;
+    int gamesUsed = 0;
+
+    for (const auto &game : Database::loadGameList())
+    {
+        float result;
+        if (!parseResult(game.result, result))
+            continue;
+
+        chessboard.resetBoard();
+        ++gamesUsed;
+
+        int plies = 0;
+        for (const auto &turn : game.turnHistory)
+        {
+            // fortress moves and other starting arrays end the replay
+            if (!chessboard.isValidCoord(turn.initialSquare) ||
+                !chessboard.isValidCoord(turn.finalSquare) ||
+                chessboard.getPiece(turn.initialSquare) != turn.pieceMoved)
+                break;
+
+            chessboard.setCell(turn.initialSquare, "---");
+            chessboard.setCell(turn.finalSquare, turn.pieceMoved);
+
+            char toMove = (turn.player == 'w') ? 'b' : 'w';
+            if (++plies > skipPlies && isQuiet(ai, gameLogic, toMove))
+                positions.push_back({chessboard.getBoardState(), result});
+        }
+    }
+
+    return gamesUsed;
+}
+
+// "w:<330 piece characters> 1-0" or "<notation> 1-0" lines, anything else
+// is skipped
+static int collectFile(AI &ai, const std::string &path,
+                       std::vector<TrainingPosition> &positions)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "Could not open positions file: " << path << std::endl;
+        return -1;
+    }
+
+    GameLogic gameLogic;
+    constexpr size_t boardLength = Chessboard::rows * Chessboard::cols * 3;
+    int added = 0;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        // the result is the last field, the position everything before it
+        size_t split = line.find_last_of(' ');
+        float result;
+        if (split == std::string::npos || !parseResult(line.substr(split + 1), result))
+            continue;
+        std::string_view position(line.data(), line.find_last_not_of(' ', split) + 1);
+
+        Notation::Position parsed;
+        if (position.size() == 2 + boardLength && position[1] == ':' &&
+            (position[0] == 'w' || position[0] == 'b'))
+        {
+            for (int row = 0; row < Chessboard::rows; ++row)
+            {
+                for (int col = 0; col < Chessboard::cols; ++col)
+                {
+                    size_t offset = 2 + (row * Chessboard::cols + col) * 3;
+                    parsed.board.board[row][col] = Types::Piece(std::string(position.substr(offset, 3)));
+                }
+            }
+            parsed.sideToMove = position[0];
+        }
+        else if (!Notation::parse(position, parsed))
+            continue;
+
+        chessboard.setBoard(parsed.board);
+        if (isQuiet(ai, gameLogic, parsed.sideToMove))
+        {
+            positions.push_back({parsed.board, result});
+            ++added;
+        }
+    }
+
+    return added;
+}
+
+// every record of a self-play file, or `sample` of them picked at random
+static int collectData(AI &ai, const std::string &path, size_t sample,
+                       std::vector<TrainingPosition> &positions)
+{
+    TrainingData::Reader reader;
+    if (!reader.open(path))
+    {
+        std::cerr << "Could not open training data: " << path << std::endl;
+        return -1;
+    }
+
+    std::vector<TrainingData::Record> records;
+    if (sample > 0)
+    {
+        std::mt19937 rng(1);
+        records = reader.sample(sample, rng);
+    }
+    else
+    {
+        for (size_t i = 0; i < reader.size(); ++i)
+            records.push_back(reader[i]);
+    }
+
+    GameLogic gameLogic;
+    int added = 0;
+    for (const auto &record : records)
+    {
+        Types::Board board = TrainingData::unpack(record);
+        chessboard.setBoard(board);
+        if (isQuiet(ai, gameLogic, record.sideToMove))
+        {
+            positions.push_back({board, (record.result + 1) / 2.0f});
+            ++added;
+        }
+    }
+
+    return added;
+}
+
+// the workers live as long as the function, each with its own board and
+// evaluator, and sum their range of the positions whenever it is called
+class ErrorFunction
+{
+public:
+    ErrorFunction(const std::vector<TrainingPosition> &positions, int threads)
+        : positions(positions), sums(threads, 0.0)
+    {
+        for (int worker = 0; worker < threads; ++worker)
+            workers.emplace_back(&ErrorFunction::work, this, worker);
+    }
+
+    ~ErrorFunction()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        started.notify_all();
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    // mean squared error of the current Evaluation weights at scaling k
+    double operator()(double k)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        // the weights being tried are this thread's, hand them on
+        jobWeights = Evaluation::weights();
+        jobK = k;
+        remaining = static_cast<int>(workers.size());
+        ++generation;
+        started.notify_all();
+        finished.wait(lock, [this]()
+                      { return remaining == 0; });
+
+        double total = 0.0;
+        for (double sum : sums)
+            total += sum;
+        return total / static_cast<double>(positions.size());
+    }
+
+private:
+    void work(int worker)
+    {
+        Types::SearchOptions options;
+        options.hashSizeMb = 0;
+        options.evalCacheSizeMb = 0;
+        AI evaluator(chessboard, options);
+
+        size_t chunk = (positions.size() + sums.size() - 1) / sums.size();
+        size_t begin = std::min(positions.size(), worker * chunk);
+        size_t end = std::min(positions.size(), begin + chunk);
+        int done = 0;
+
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            started.wait(lock, [this, done]()
+                         { return stopping || generation != done; });
+            if (stopping)
+                return;
+            done = generation;
+            double k = jobK;
+            if (!(jobWeights == Evaluation::weights()))
+            {
+                Evaluation::setWeights(jobWeights);
+                // its pawn hash holds scores of the old weights
+                evaluator.clearEvaluationCaches();
+            }
+            lock.unlock();
+
+            double sum = 0.0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                chessboard.setBoard(positions[i].board);
+                double expected = 1.0 / (1.0 + std::pow(10.0, -k * evaluator.evaluateBoard() / 4.0));
+                double difference = positions[i].result - expected;
+                sum += difference * difference;
+            }
+
+            lock.lock();
+            sums[worker] = sum;
+            if (--remaining == 0)
+                finished.notify_one();
+        }
+    }
+
+    const std::vector<TrainingPosition> &positions;
+    std::vector<double> sums;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable started;
+    std::condition_variable finished;
+    // the call being worked on, counted so a worker sums each one once
+    int generation = 0;
+    int remaining = 0;
+    double jobK = 1.0;
+    Evaluation::Weights jobWeights;
+    bool stopping = false;
+};
+
+// narrows a grid search around the best K, the error is smooth in K
+static double fitScaling(ErrorFunction &error)
+{
+    double best = 1.0;
+    double bestError = error(best);
+    for (double step = 0.5; step >= 0.005; step /= 2.0)
+    {
+        bool improved = true;
+        while (improved)
+        {
+            improved = false;
+            for (double candidate : {best - step, best + step})
+            {
+                if (candidate <= 0.0)
+                    continue;
+                double candidateError = error(candidate);
+                if (candidateError < bestError)
+                {
+                    best = candidate;
+                    bestError = candidateError;
+                    improved = true;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::string> positionFiles;
+    std::vector<std::string> dataFiles;
+    size_t sample = 0;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    int skipPlies = 8;
+    int passes = 50;
+    std::string output = Evaluation::DEFAULT_WEIGHTS_PATH;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--positions" && hasValue)
+            positionFiles.push_back(argv[++i]);
+        else if (arg == "--data" && hasValue)
+            dataFiles.push_back(argv[++i]);
+        else if (arg == "--sample" && hasValue)
+            sample = static_cast<size_t>(std::stoll(argv[++i]));
+        else if (arg == "--threads" && hasValue)
+            threads = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--skip-plies" && hasValue)
+            skipPlies = std::stoi(argv[++i]);
+        else if (arg == "--passes" && hasValue)
+            passes = std::stoi(argv[++i]);
+        else if (arg == "--out" && hasValue)
+            output = argv[++i];
+        else
+        {
+            std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    // keep tuning from the last run when there was one
+    if (Evaluation::loadWeights(output))
+        std::cout << "starting from " << output << std::endl;
+
+    Types::SearchOptions options;
+    options.hashSizeMb = 0;
+    options.evalCacheSizeMb = 0;
+    AI ai(chessboard, options);
+
+    std::vector<TrainingPosition> positions;
+    int games = collectArchive(ai, skipPlies, positions);
+    std::cout << positions.size() << " quiet positions from " << games
+              << " archived games" << std::endl;
+    for (const auto &path : positionFiles)
+    {
+        int added = collectFile(ai, path, positions);
+        if (added < 0)
+            return 1;
+        std::cout << added << " quiet positions from " << path << std::endl;
+    }
+    for (const auto &path : dataFiles)
+    {
+        int added = collectData(ai, path, sample, positions);
+        if (added < 0)
+            return 1;
+        std::cout << added << " quiet positions from " << path << std::endl;
+    }
+    if (positions.empty())
+    {
+        std::cout << "No positions to tune on, is the games/ archive empty?" << std::endl;
+        return 1;
+    }
+
+    ErrorFunction error(positions, threads);
+    double k = fitScaling(error);
+    double bestError = error(k);
+    std::cout << "K = " << k << ", error " << bestError << std::endl;
+
+    Evaluation::Weights weights = Evaluation::weights();
+    auto parameters = Evaluation::parameters(weights);
+    float step = 0.1f;
+
+    for (int pass = 1; pass <= passes && step >= 0.01f; ++pass)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        bool improved = false;
+        for (auto &[name, value] : parameters)
+        {
+            const float original = *value;
+            for (float delta : {step, -step})
+            {
+                *value = original + delta;
+                Evaluation::setWeights(weights);
+                double candidateError = error(k);
+                if (candidateError < bestError)
+                {
+                    bestError = candidateError;
+                    improved = true;
+                    break;
+                }
+                *value = original;
+            }
+            Evaluation::setWeights(weights);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed = end - start;
+
+        std::cout << "pass " << pass << ": error " << bestError << ", step " << step
+                  << " (" << elapsed.count() << "s)" << std::endl;
+        if (!improved)
+            step /= 2.0f;
+
+        // a run can be stopped at any point and keep what it found
+        if (!Evaluation::saveWeights(output, weights))
+        {
+            std::cerr << "Could not write " << output << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "wrote " << parameters.size() << " weights to " << output << std::endl;
+    return 0;
+}
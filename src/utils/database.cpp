@@ -1,5 +1,6 @@
 // Copyright 2024. mirror-shades. GPL-2.0 License.
 #include "database.h"
+#include "trace.h"
 #include "types.h"
 #include "state.h"
 #include <fstream>
@@ -26,6 +27,7 @@ std::string Database::generateGameFilename(int id) {
 }
 
 bool Database::saveGame(const Types::GameRecord& game) {
+    TRACE_ZONE("Database::saveGame");
     std::string filename = generateGameFilename(game.id);
     return writeGameToCSV(game, filename);
 }
@@ -134,11 +136,13 @@ Types::GameRecord Database::parseGameFromCSV(const std::string& filepath) {
 }
 
 Types::GameRecord Database::loadGame(int gameId) {
+    TRACE_ZONE("Database::loadGame");
     std::string filename = generateGameFilename(gameId);
     return parseGameFromCSV(filename);
 }
 
 std::vector<Types::GameRecord> Database::loadGameList() {
+    TRACE_ZONE("Database::loadGameList");
     std::vector<Types::GameRecord> games;
     std::string gamesDir = getGamesDirectory();
     
@@ -205,6 +209,7 @@ int Database::getNextGameId() {
 }
 
 bool Database::saveActiveGame() {
+    TRACE_ZONE("Database::saveActiveGame");
     // Only save if we have a valid game ID and some moves
     if (State::currentGameId < 0 || State::turnHistory.empty()) {
         return false;
@@ -245,6 +250,7 @@ bool Database::saveActiveGame() {
 }
 
 bool Database::saveCompletedGame() {
+    TRACE_ZONE("Database::saveCompletedGame");
     // Only save if we have a valid game ID
     if (State::currentGameId < 0) {
         return false;
@@ -294,6 +300,7 @@ bool Database::saveCompletedGame() {
 }
 
 Types::GameRecord Database::loadActiveGame() {
+    TRACE_ZONE("Database::loadActiveGame");
     std::string filename = getActiveGameFilename();
     if (!std::filesystem::exists(filename)) {
         Types::GameRecord empty;  // Default constructor initializes id to -1
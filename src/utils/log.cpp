@@ -0,0 +1,215 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#include "log.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+namespace
+{
+    // bounded queue after Dmitry Vyukov, any thread pushes and the writer
+    // thread alone pops. A slot's sequence says whose turn it is: equal to
+    // the position when free, one past it once filled
+    class Writer
+    {
+    public:
+        Writer()
+        {
+            for (size_t i = 0; i < Log::QUEUE_SIZE; ++i)
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+            thread = std::thread(&Writer::run, this);
+        }
+
+        ~Writer()
+        {
+            stopping.store(true);
+            wake();
+            thread.join();
+        }
+
+        // a line longer than a slot takes as many consecutive ones as it
+        // needs, claimed in one go so nothing lands between the pieces
+        void push(Log::Level level, const char *text, size_t length)
+        {
+            size_t pieces = std::clamp<size_t>((length + Log::MESSAGE_SIZE - 1) / Log::MESSAGE_SIZE,
+                                               1, Log::QUEUE_SIZE);
+            length = std::min(length, pieces * Log::MESSAGE_SIZE);
+            size_t position = enqueuePosition.load(std::memory_order_relaxed);
+            while (true)
+            {
+                // the writer frees slots in order, so the last one free
+                // means the ones before it are too
+                size_t last = position + pieces - 1;
+                Slot &slot = slots[last & (Log::QUEUE_SIZE - 1)];
+                size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(last);
+                if (difference == 0)
+                {
+                    if (enqueuePosition.compare_exchange_weak(position, position + pieces,
+                                                              std::memory_order_relaxed))
+                    {
+                        for (size_t piece = 0; piece < pieces; ++piece)
+                        {
+                            Slot &filled = slots[(position + piece) & (Log::QUEUE_SIZE - 1)];
+                            size_t offset = piece * Log::MESSAGE_SIZE;
+                            filled.level = level;
+                            filled.length = std::min(Log::MESSAGE_SIZE, length - offset);
+                            filled.continued = piece + 1 < pieces;
+                            for (size_t i = 0; i < filled.length; ++i)
+                                filled.text[i] = text[offset + i];
+                            filled.sequence.store(position + piece + 1, std::memory_order_release);
+                        }
+                        wake();
+                        return;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    // full, the writer is behind
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                else
+                    position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        void flush()
+        {
+            size_t target = enqueuePosition.load();
+            wake();
+            while (writtenPosition.load() < target)
+                std::this_thread::yield();
+        }
+
+    private:
+        struct Slot
+        {
+            std::atomic<size_t> sequence;
+            Log::Level level;
+            size_t length;
+            // the line goes on in the next slot
+            bool continued;
+            char text[Log::MESSAGE_SIZE];
+        };
+
+        bool ready() const
+        {
+            const Slot &slot = slots[dequeuePosition & (Log::QUEUE_SIZE - 1)];
+            return slot.sequence.load(std::memory_order_acquire) == dequeuePosition + 1;
+        }
+
+        // the writer only sleeps after saying so and finding the queue still
+        // empty, and pushers look after publishing, so a wake is never lost
+        void wake()
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleeping.load() && sleeping.exchange(false))
+                sleeping.notify_one();
+        }
+
+        void run()
+        {
+            while (true)
+            {
+                bool wrote = false;
+                while (ready())
+                {
+                    Slot &slot = slots[dequeuePosition & (Log::QUEUE_SIZE - 1)];
+                    std::FILE *out = slot.level >= Log::Level::Warning ? stderr : stdout;
+                    std::fwrite(slot.text, 1, slot.length, out);
+                    if (!slot.continued)
+                        std::fputc('\n', out);
+                    slot.sequence.store(dequeuePosition + Log::QUEUE_SIZE, std::memory_order_release);
+                    ++dequeuePosition;
+                    wrote = true;
+                }
+
+                size_t lost = dropped.exchange(0, std::memory_order_relaxed);
+                if (lost > 0)
+                {
+                    std::fprintf(stderr, "%zu log lines dropped\n", lost);
+                    wrote = true;
+                }
+                if (wrote)
+                {
+                    std::fflush(stdout);
+                    std::fflush(stderr);
+                    writtenPosition.store(dequeuePosition);
+                    continue;
+                }
+
+                if (stopping.load())
+                    return;
+                sleeping.store(true);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (ready() || stopping.load())
+                {
+                    sleeping.store(false);
+                    continue;
+                }
+                sleeping.wait(true);
+            }
+        }
+
+        Slot slots[Log::QUEUE_SIZE];
+        std::atomic<size_t> enqueuePosition{0};
+        std::atomic<size_t> writtenPosition{0};
+        std::atomic<size_t> dropped{0};
+        std::atomic<bool> sleeping{false};
+        std::atomic<bool> stopping{false};
+        // the writer thread's own
+        size_t dequeuePosition = 0;
+        std::thread thread;
+    };
+
+    // started with the first line logged, drained and joined at exit
+    Writer &writer()
+    {
+        static Writer instance;
+        return instance;
+    }
+}
+
+Log::Line::Line(Level lineLevel)
+    : level(lineLevel), buffer(text, MESSAGE_SIZE), stream(&buffer)
+{
+}
+
+Log::Line::~Line()
+{
+    size_t length = buffer.length();
+    while (length > 0 && text[length - 1] == '\n')
+        --length;
+    push(level, text, length);
+}
+
+bool Log::parseLevel(std::string_view name, Level &level)
+{
+    if (name == "debug")
+        level = Level::Debug;
+    else if (name == "info")
+        level = Level::Info;
+    else if (name == "warning")
+        level = Level::Warning;
+    else if (name == "error")
+        level = Level::Error;
+    else
+        return false;
+    return true;
+}
+
+void Log::push(Level level, const char *text, size_t length)
+{
+    writer().push(level, text, length);
+}
+
+void Log::record(std::string_view text)
+{
+    writer().push(Level::Warning, text.data(), text.size());
+}
+
+void Log::flush()
+{
+    writer().flush();
+}
@@ -0,0 +1,90 @@
+// Copyright 2024. mirror-shades. GPL-2.0 License.
+#include "trace.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+std::mutex Trace::registryMutex;
+std::vector<std::shared_ptr<Trace::Buffer>> Trace::registry;
+
+namespace
+{
+    // ticks and steady clock at start up, to turn ticks into time
+    const int64_t originTicks = Trace::now();
+    const auto originTime = std::chrono::steady_clock::now();
+}
+
+Trace::Buffer *Trace::registerThread()
+{
+    auto created = std::make_shared<Buffer>();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    created->threadId = static_cast<int>(registry.size()) + 1;
+    registry.push_back(created);
+    localBuffer = created.get();
+    return localBuffer;
+}
+
+void Trace::setThreadName(const char *name)
+{
+    Buffer *buffer = localBuffer ? localBuffer : registerThread();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffer->threadName = name;
+}
+
+// complete ("X") events in microseconds, with a name entry per thread
+bool Trace::write(const std::string &path)
+{
+    if (!compiledIn())
+    {
+        std::cerr << "Built without tracing, configure with -DTAMERLANE_TRACING=ON" << std::endl;
+        return false;
+    }
+
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cerr << "Failed to open trace file: " << path << std::endl;
+        return false;
+    }
+
+    double elapsed = std::chrono::duration<double, std::micro>(
+                         std::chrono::steady_clock::now() - originTime)
+                         .count();
+    double ticksPerMicrosecond = static_cast<double>(now() - originTicks) /
+                                 std::max(elapsed, 1.0);
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+    bool first = true;
+    auto separator = [&]()
+    {
+        if (!first)
+            file << ",\n";
+        first = false;
+    };
+
+    for (const auto &buffer : registry)
+    {
+        if (!buffer->threadName.empty())
+        {
+            separator();
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+                 << buffer->threadId << ",\"args\":{\"name\":\"" << buffer->threadName << "\"}}";
+        }
+
+        uint64_t written = buffer->written.load(std::memory_order_acquire);
+        uint64_t begin = written > BUFFER_EVENTS ? written - BUFFER_EVENTS : 0;
+        for (uint64_t i = begin; i < written; ++i)
+        {
+            const Event &event = buffer->events[i & (BUFFER_EVENTS - 1)];
+            separator();
+            file << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                 << buffer->threadId
+                 << ",\"ts\":" << static_cast<double>(event.start - originTicks) / ticksPerMicrosecond
+                 << ",\"dur\":" << static_cast<double>(event.duration) / ticksPerMicrosecond << "}";
+        }
+    }
+    file << "],\"displayTimeUnit\":\"ms\"}\n";
+    return file.good();
+}
@@ -15,6 +15,7 @@
 #include "state.h"
 #include "ai.h"
 #include "database.h"
+#include "log.h"
 #include <filesystem>
 
 // Add these as member variables in the Utility class or as global variables
@@ -106,12 +107,12 @@ bool Utility::checkVictoryCondition(
         if (kingInCheck)
         {
             State::winner = player;
-            std::cout << player << " has won by checkmate" << std::endl;
+            LOG_INFO(player << " has won by checkmate");
         }
         else
         {
             State::winner = 's';
-            std::cout << "The game is a draw by stalemate" << std::endl;
+            LOG_INFO("The game is a draw by stalemate");
         }
         State::gameOver = true;
         
@@ -169,7 +170,7 @@ void Utility::updateGameState(
     {
         State::winner = 'd';
         State::gameOver = true;
-        std::cout << "Game ended in a draw by threefold repetition" << std::endl;
+        LOG_INFO("Game ended in a draw by threefold repetition");
         // Save completed game to database
         Database::saveCompletedGame();
     }
@@ -217,21 +218,21 @@ void Utility::undoLastMove()
         State::moveList.clear();
         State::selectedSquare = {-1, -1};
 
-        std::cout << "Undo move: "
-                  << lastTurn.pieceMoved.toString()
-                  << " from ("
-                  << lastTurn.finalSquare.x
-                  << ", "
-                  << lastTurn.finalSquare.y
-                  << ") to ("
-                  << lastTurn.initialSquare.x
-                  << ", "
-                  << lastTurn.initialSquare.y
-                  << ")" << std::endl;
+        LOG_INFO("Undo move: "
+                 << lastTurn.pieceMoved.toString()
+                 << " from ("
+                 << lastTurn.finalSquare.x
+                 << ", "
+                 << lastTurn.finalSquare.y
+                 << ") to ("
+                 << lastTurn.initialSquare.x
+                 << ", "
+                 << lastTurn.initialSquare.y
+                 << ")");
     }
     else
     {
-        std::cout << "No moves to undo" << std::endl;
+        LOG_INFO("No moves to undo");
     }
 }
 
@@ -266,7 +267,7 @@ int Utility::scoreMaterial()
 // Exit to menu
 void Utility::exitToMenu()
 {
-    std::cout << "Exiting game" << std::endl;
+    LOG_INFO("Exiting game");
     
     // Save active game state before exiting (if game is in progress)
     if (!State::gameOver && State::currentGameId >= 0 && !State::turnHistory.empty()) {
@@ -372,12 +373,11 @@ bool Utility::clickHandler(sf::Event event, sf::RenderWindow &window)
 bool Utility::clickLogic(int x, int y)
 {
     Types::Coord coord = calculateSquare(x, y);
-    std::cout << coord.x
+    LOG_DEBUG(coord.x
               << ", "
               << coord.y
               << " | "
-              << chessboard.getPiece(coord).toString()
-              << std::endl;
+              << chessboard.getPiece(coord).toString());
     const char player = (State::turns % 2 == 0) ? 'b' : 'w';
     std::string selected = chessboard.getPiece(coord).toString();
 
@@ -392,7 +392,7 @@ bool Utility::clickLogic(int x, int y)
         {
             State::winner = 'd';
             State::gameOver = true;
-            std::cout << "Game ended in a draw" << std::endl;
+            LOG_INFO("Game ended in a draw");
             // Save completed game to database
             Database::saveCompletedGame();
             return false;
@@ -407,7 +407,7 @@ bool Utility::clickLogic(int x, int y)
         {
             State::winner = 'd';
             State::gameOver = true;
-            std::cout << "Game ended in a draw" << std::endl;
+            LOG_INFO("Game ended in a draw");
             // Save completed game to database
             Database::saveCompletedGame();
             return false;
@@ -506,7 +506,7 @@ void Utility::handlePieceMovement(
     if (gameOver)
     {
         State::gameOver = true;
-        std::cout << "Game over. Winner: " << State::winner << std::endl;
+        LOG_INFO("Game over. Winner: " << State::winner);
     }
 }
 